@@ -33,4 +33,41 @@ inline bool isCharging() {
   return voltage > BATTERY_MAX_V + 0.1;
 }
 
+// Power state machine (persisted in RTC memory)
+enum PowerState : uint8_t {
+  POWER_NORMAL = 0, // Everything enabled
+  POWER_REDUCED,    // Skip weather/remote checks, sleep longer
+  POWER_CRITICAL    // Last frame drawn, wake on button only
+};
+
+// Next power state for the current battery level. Leaving a state needs
+// BATTERY_HYSTERESIS_PCT extra so the device doesn't flip-flop around a
+// threshold as the voltage sags under load.
+inline PowerState updatePowerState(PowerState current, int percentage,
+                                   bool charging) {
+  if (charging)
+    return POWER_NORMAL;
+
+  int critical = BATTERY_CRITICAL_PCT;
+  int reduced = BATTERY_REDUCED_PCT;
+  if (current >= POWER_CRITICAL)
+    critical += BATTERY_HYSTERESIS_PCT;
+  if (current >= POWER_REDUCED)
+    reduced += BATTERY_HYSTERESIS_PCT;
+
+  PowerState next = POWER_NORMAL;
+  if (percentage < critical) {
+    next = POWER_CRITICAL;
+  } else if (percentage < reduced) {
+    next = POWER_REDUCED;
+  }
+
+  if (next != current) {
+    static const char *names[] = {"normal", "reduced", "critical"};
+    Serial.printf("Power state: %s -> %s (battery %d%%)\n", names[current],
+                  names[next], percentage);
+  }
+  return next;
+}
+
 #endif // BATTERY_H
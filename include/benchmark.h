@@ -0,0 +1,171 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "canvas.h"
+#include "config.h"
+#include "forecast_parser.h"
+#include "heap_stats.h"
+#include "icons.h"
+#include "json_arena.h"
+#include "json_stream.h"
+#include "remote_image.h"
+#include "time_manager.h"
+#include "weather_view.h"
+#include "widgets.h"
+#include <Arduino.h>
+#include <mbedtls/base64.h>
+
+// Benchmarks for the CPU-bound code that runs on every wake. Built on the
+// host by [env:native_bench] (src/host/bench_cli.cpp), which loads the
+// forecast.json fixtures, compares the times with a recorded baseline and
+// prints the results. Every case must also stay within its allocation
+// budget: icon lookup, parsing and drawing do not allocate by design.
+
+#define BENCH_ITERATIONS 1000
+#define BENCH_ROUNDS 9
+#define BENCH_MAX_CASES 16
+
+// Per-call figures of one case
+struct BenchResult {
+  const char *name;
+  uint32_t ns;
+  uint32_t allocs;
+  uint32_t bytes;
+  int maxAllocs; // Allocation budget (-1: not checked)
+};
+
+struct BenchResults {
+  BenchResult cases[BENCH_MAX_CASES];
+  int count;
+};
+
+// forecast.json responses to parse (see bench/)
+struct BenchPayloads {
+  const char *small;
+  const char *medium;
+  const char *large;
+};
+
+// Run fn BENCH_ROUNDS x BENCH_ITERATIONS times and record per-call
+// figures. The fastest round is kept: the others were slowed down by
+// something else on the machine.
+template <typename Fn>
+inline void runBench(BenchResults &results, const char *name, Fn fn,
+                     int maxAllocs) {
+  fn(); // Warm up caches and one-time allocations
+
+  uint32_t best = UINT32_MAX;
+  HeapStats heapStart = heapStatsNow();
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    uint32_t start = micros();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+      fn();
+    }
+    best = min(best, (uint32_t)(micros() - start));
+  }
+  HeapStats heap = heapStatsSince(heapStart);
+  uint32_t calls = BENCH_ROUNDS * BENCH_ITERATIONS;
+
+  if (results.count >= BENCH_MAX_CASES)
+    return;
+  BenchResult &result = results.cases[results.count++];
+  result.name = name;
+  result.ns = (uint64_t)best * 1000 / BENCH_ITERATIONS;
+  result.allocs = heap.allocs / calls;
+  result.bytes = heap.bytes / calls;
+  result.maxAllocs = maxAllocs;
+}
+
+// Lookup results land here so they are not optimised away
+static const unsigned char *volatile benchIcon;
+
+// A string in memory as a Stream (stands in for the HTTP body)
+class BenchStream : public Stream {
+private:
+  const char *data;
+  size_t length;
+  size_t pos;
+
+public:
+  explicit BenchStream(const char *data)
+      : data(data), length(strlen(data)), pos(0) {}
+  int available() override { return length - pos; }
+  int read() override { return pos < length ? data[pos++] : -1; }
+  int peek() override { return pos < length ? data[pos] : -1; }
+  size_t write(uint8_t) override { return 0; }
+};
+
+inline void runBenchmarks(Canvas &canvas, const BenchPayloads &payloads,
+                          BenchResults &results) {
+  static uint8_t arenaBuffer[WEATHER_ARENA_SIZE] __attribute__((aligned(8)));
+  static uint8_t image[REMOTE_BUFFER_SIZE] __attribute__((aligned(4)));
+  // The image as a JSON string value, as it arrives in a response
+  static char imageJson[((PANEL_BUFFER_SIZE + 2) / 3) * 4 + 3];
+  static JsonArena arena(arenaBuffer, sizeof(arenaBuffer));
+  static WeatherData weather;
+  static WeatherView view;
+  results.count = 0;
+
+  // Weather icon lookup over typical conditions
+  static const char *const conditions[] = {
+      "Sol",     "Parcialmente nublado", "Nublado", "Chuva moderada",
+      "Neblina", "Trovoada",             "Neve",    "Desconhecido"};
+  runBench(results, "getWeatherIcon", [&]() {
+    for (size_t i = 0; i < sizeof(conditions) / sizeof(conditions[0]); i++) {
+      benchIcon = getWeatherIcon(conditions[i], i % 2);
+    }
+  }, 0);
+
+  // forecast.json parsing at several payload sizes
+  runBench(results, "parseWeather/small",
+           [&]() { parseForecast(payloads.small, arena, weather); }, 0);
+  runBench(results, "parseWeather/medium",
+           [&]() { parseForecast(payloads.medium, arena, weather); }, 0);
+  runBench(results, "parseWeather/large",
+           [&]() { parseForecast(payloads.large, arena, weather); }, 0);
+
+  // Remote image: streamed base64 decode, then blit with and without
+  // inversion
+  for (size_t i = 0; i < PANEL_BUFFER_SIZE; i++) {
+    image[i] = i * 31;
+  }
+  size_t encoded = 0;
+  imageJson[0] = '"';
+  mbedtls_base64_encode((unsigned char *)imageJson + 1, sizeof(imageJson) - 2,
+                        &encoded, image, PANEL_BUFFER_SIZE);
+  strcpy(imageJson + 1 + encoded, "\"");
+  size_t imageSize = 0;
+  runBench(results, "readRemoteImage", [&]() {
+    // readRemoteImage() without its log line
+    BenchStream stream(imageJson);
+    JsonStreamReader reader(stream);
+    reader.readBase64(image, REMOTE_BUFFER_SIZE, &imageSize);
+    padRemoteImage(image, imageSize, REMOTE_IMAGE_PANEL_LAYOUT);
+  }, 0);
+  runBench(results, "blit/panel",
+           [&]() { canvas.drawFullImage(image, true, false); }, 0);
+  runBench(results, "blit/panel-inverted",
+           [&]() { canvas.drawFullImage(image, true, true); }, 0);
+  runBench(results, "blit/rows-inverted",
+           [&]() { canvas.drawFullImage(image, false, true); }, 0);
+
+  // Text measurement and drawing
+  canvas.setFont(&FreeSans9pt7b);
+  runBench(results, "drawText", [&]() {
+    canvas.drawText("Bom dia! Tenha um otimo dia", 68, ALIGN_CENTER);
+  }, 0);
+
+  // Per-fetch view model, then the full main screen render into the
+  // framebuffer (what drawMainScreen() draws before the panel refresh)
+  updateTimeStrings(1718000000); // Fixed time, same text every run
+  parseForecast(payloads.medium, arena, weather);
+  runBench(results, "buildWeatherView",
+           [&]() { buildWeatherView(canvas, weather, view); }, 0);
+  ScreenData screen = makeScreenData(view, true, true, icon_battery_full);
+  runBench(results, "renderMainScreen", [&]() {
+    canvas.clear();
+    renderWidgets(canvas, screen, ALL_WIDGETS);
+  }, 0);
+}
+
+#endif // BENCHMARK_H
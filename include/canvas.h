@@ -0,0 +1,128 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <Arduino.h>
+#include <Fonts/FreeMonoBold9pt7b.h>
+#include <Fonts/FreeMonoBold12pt7b.h>
+#include <Fonts/FreeMonoBold18pt7b.h>
+#include <Fonts/FreeSans9pt7b.h>
+#include <Fonts/FreeSansBold9pt7b.h>
+#include "config.h"
+#include "frame_buffer.h"
+
+// Drawing half of the display: text, shapes and bitmaps into the
+// framebuffer, no panel. DisplayManager adds the panel and its refreshes;
+// the host frame renderer (src/host/) draws on a bare Canvas.
+
+enum TextAlignment {
+    ALIGN_LEFT = 0,
+    ALIGN_CENTER,
+    ALIGN_RIGHT
+};
+
+class Canvas {
+protected:
+    FrameBuffer frame;
+
+public:
+    Canvas() {
+        frame.setRotation(DISPLAY_ROTATION);
+        frame.fillScreen(GxEPD_WHITE);
+        frame.setTextColor(GxEPD_BLACK);
+    }
+
+    void clear() {
+        frame.fillScreen(GxEPD_WHITE);
+    }
+
+    void setFont(const GFXfont* font) {
+        frame.setFont(font);
+    }
+
+    void drawText(const char* text, int16_t y, TextAlignment align) {
+        int16_t x = 0;
+        int16_t x1, y1;
+        uint16_t w, h;
+
+        frame.getTextBounds(text, 0, y, &x1, &y1, &w, &h);
+
+        switch (align) {
+            case ALIGN_LEFT:
+                x = 2;
+                break;
+            case ALIGN_CENTER:
+                x = (frame.width() - w) / 2;
+                break;
+            case ALIGN_RIGHT:
+                x = frame.width() - w - 2;
+                break;
+        }
+
+        frame.setCursor(x, y);
+        frame.print(text);
+    }
+
+    // Align text within a box [x, x + w) instead of the whole screen
+    void drawTextIn(const char* text, int16_t x, int16_t w, int16_t y,
+                    TextAlignment align) {
+        int16_t tw = textWidth(text);
+        if (align == ALIGN_CENTER) {
+            x += (w - tw) / 2;
+        } else if (align == ALIGN_RIGHT) {
+            x += w - tw;
+        }
+
+        frame.setCursor(x, y);
+        frame.print(text);
+    }
+
+    int16_t textWidth(const char* text) {
+        int16_t x1, y1;
+        uint16_t w, h;
+        frame.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+        return w;
+    }
+
+    void drawTextAt(const char* text, int16_t x, int16_t y) {
+        frame.setCursor(x, y);
+        frame.print(text);
+    }
+
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+        frame.drawLine(x0, y0, x1, y1, GxEPD_BLACK);
+    }
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+        frame.drawRect(x, y, w, h, GxEPD_BLACK);
+    }
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, bool black = true) {
+        frame.fillRect(x, y, w, h, black ? GxEPD_BLACK : GxEPD_WHITE);
+    }
+
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h) {
+        frame.drawBitmap(x, y, bitmap, w, h, GxEPD_BLACK);
+    }
+
+    // Full screen image straight into the framebuffer.
+    // panelLayout: image is in panel RAM layout (PANEL_BUFFER_SIZE bytes),
+    // otherwise row-major in logical orientation.
+    // invert: image uses 1 for black (the panel uses 1 for white).
+    void drawFullImage(const uint8_t* image, bool panelLayout, bool invert) {
+        if (panelLayout) {
+            frame.blitPanelImage(image, invert);
+        } else {
+            frame.blitRowImage(image, invert);
+        }
+    }
+
+    int16_t width() { return frame.width(); }
+    int16_t height() { return frame.height(); }
+
+    // Raw framebuffer in panel RAM layout (PANEL_BUFFER_SIZE bytes)
+    uint8_t* getFrameBuffer() { return frame.getBuffer(); }
+
+    FrameBuffer* getDisplay() { return &frame; }
+};
+
+#endif // CANVAS_H
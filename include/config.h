@@ -2,20 +2,44 @@
 #define CONFIG_H
 
 // ==================== WiFi Configuration ====================
-// #define WIFI_SSID "MEO-7678E0"
-// #define WIFI_PASSWORD "8413d8d54c"
-#define WIFI_SSID "Ainda sem internet"
-#define WIFI_PASSWORD "taseminternet"
+// Known networks as {ssid, password}, up to WIFI_MAX_NETWORKS. The one
+// that connected fastest before is tried first, on its cached channel.
+#define WIFI_NETWORKS                                                          \
+  {"Ainda sem internet", "taseminternet"}, {"MEO-7678E0", "8413d8d54c"}
+#define WIFI_FAST_TIMEOUT_MS 4000     // Cached channel/BSSID attempt
+#define WIFI_CONNECT_TIMEOUT_MS 10000 // Attempt after a scan
+#define WIFI_SCAN_MS_PER_CHANNEL 120  // Active scan dwell time
 
 // ==================== Time Configuration ====================
 #define NTP_SERVER "0.pt.pool.ntp.org"
 #define GMT_OFFSET_SEC (0 * 3600) // GMT+0
 #define DAYLIGHT_OFFSET_SEC 0
+#define TIME_MAX_AGE_SEC 900 // Trust the RTC this long after a server time
+#define TIME_DRIFT_MAX_SEC 2 // Correct the clock when off by more than this
 
 // ==================== Weather API Configuration ====================
 // Get your free API key at: https://www.weatherapi.com/
 #define WEATHER_API_KEY "beddfb8faa514e29948102955252612"
 #define WEATHER_LOCATION "Porto,PT" // City name, coordinates, or IP address
+// Switch to https:// once TLS_CA_CERT or TLS_FINGERPRINT is set below
+#define WEATHER_API_URL "http://api.weatherapi.com/v1/forecast.json"
+
+// ==================== Network ====================
+#define DNS_CACHE_TTL_SEC 3600 // Keep resolved API addresses across wakes
+
+// HTTPS (used for any https:// URL). Pin the server with CA certificates
+// (PEM, several may be concatenated) or the SHA-256 fingerprint of its
+// certificate (hex). With neither, https:// URLs are refused.
+#define TLS_CA_CERT ""
+#define TLS_FINGERPRINT ""
+
+// ==================== Firmware Updates ====================
+#define FIRMWARE_VERSION 1    // Sent to the remote endpoint, bump per release
+#define OTA_PROBATION_WAKES 3 // A crash in this many wakes rolls back
+
+// ==================== Telemetry ====================
+#define TELEMETRY_URL ""       // Batched record upload ("" = SD card only)
+#define TELEMETRY_UPLOAD_MIN 8 // Pending records needed before an upload
 
 // ==================== E-Ink Display Pins ====================
 #define SPI_MOSI 23
@@ -26,6 +50,7 @@
 #define ELINK_BUSY 4
 #define ELINK_RESET 16
 #define ELINK_DC 17
+#define EPD_SPI_FREQUENCY 20000000 // SSD1680 max write clock (50 ns cycle)
 
 // ==================== SD Card Pins ====================
 #define SDCARD_SS 13
@@ -41,17 +66,86 @@
 #define BATTERY_MAX_V 4.2 // Max voltage (fully charged)
 #define BATTERY_MIN_V 3.0 // Min voltage (empty)
 
+// Power states driven by battery level
+#define BATTERY_REDUCED_PCT 20   // Below: no WiFi on timer wakes, longer sleep
+#define BATTERY_CRITICAL_PCT 5   // Below: show "charge me" and sleep on button
+#define BATTERY_HYSTERESIS_PCT 5 // Extra charge needed to leave a state
+#define REDUCED_SLEEP_SEC 300    // Sleep duration in reduced mode
+
+// ==================== ULP Monitor ====================
+// The ULP coprocessor watches button and battery during deep sleep
+#define ULP_MONITOR_ENABLED 1       // 0 = plain EXT0 button wakeup
+#define ULP_PERIOD_MS 20            // ULP program period
+#define ULP_DEBOUNCE_MS 40          // Shorter presses are ignored
+#define ULP_LONG_PRESS_MS 1500      // Long press: force full refresh
+#define ULP_DOUBLE_PRESS_MS 400     // Max gap for a double press
+#define ULP_BATTERY_SAMPLE_MS 10000 // Battery ADC sample interval
+
+// ==================== Power Profiles ====================
+// CPU frequency per wake phase (WiFi forces at least 80 MHz while up)
+#define POWER_PROFILES_ENABLED 1 // 0 = stay at the default frequency
+#define CPU_MHZ_COMPUTE 240      // Parse, decode, render
+#define CPU_MHZ_NETWORK 80       // Waiting on WiFi/HTTP
+#define CPU_MHZ_DISPLAY_WAIT 40  // Waiting on the panel BUSY pin
+#define WIFI_MODEM_SLEEP 1       // Modem sleep between HTTP requests
+
+// Current model for the energy report (mA = base + per_mhz * MHz + radio)
+#define POWER_MA_CPU_BASE 12.0
+#define POWER_MA_PER_MHZ 0.16
+#define POWER_MA_RADIO 70.0 // Average extra while WiFi is up
+
+// ==================== Energy Model ====================
+// Used with the POWER_MA_* values above for the daily projection
+#define BATTERY_CAPACITY_MAH 1000     // Battery capacity
+#define POWER_MA_SLEEP 0.15           // Deep sleep incl. ULP and regulator
+#define POWER_MAS_FULL_REFRESH 25.0   // Panel charge per full refresh (mA*s)
+#define POWER_MAS_PARTIAL_REFRESH 6.0 // Panel charge per partial refresh
+#define ENERGY_MIN_WINDOW_SEC 3600    // Data needed before projecting a day
+
 // ==================== Display Settings ====================
 #define DISPLAY_ROTATION 1 // 0-3 for different orientations
+// Logical dimensions after rotation (GxDEPG0213BN is 250x122)
+#define DISPLAY_WIDTH 250
+#define DISPLAY_HEIGHT 122
+
+// ==================== Refresh Scheduler ====================
+// Ghosting is tracked per screen region (a grid of GHOST_REGION_COLS x
+// GHOST_REGION_ROWS cells). A region is cleaned (inverted, then redrawn)
+// the next time it is updated after too many partial refreshes or too long
+// since it was last clean. The whole screen gets one full refresh per
+// night in the quiet window, when nobody is looking.
+#define GHOST_REGION_COLS 4
+#define GHOST_REGION_ROWS 2
+#define GHOST_MAX_PARTIALS 60  // Partial refreshes before a region is cleaned
+#define GHOST_MAX_AGE_MIN 240  // Clean a region dirty for longer than this
+#define QUIET_START_HOUR 2     // Nightly full refresh window (local time)
+#define QUIET_END_HOUR 5
+
+// ==================== Wake Budget ====================
+// The essential render runs first; queued network work (remote check,
+// weather, time sync, telemetry) then only starts while its estimated
+// cost fits in the budget. Hung network work is cut off at the hard limit.
+#define WAKE_BUDGET_MS 10000         // Soft budget for the whole wake
+#define WAKE_RENDER_RESERVE_MS 1500  // Kept free for the final redraw
+#define WAKE_HARD_LIMIT_MS 20000     // Forced deep sleep after this
+#define WAKE_OVERRUN_SLEEP_SEC 60    // Sleep after a forced stop
+#define WAKE_TASK_MAX_DEFERRALS 3    // Then a task runs even over budget
 
 // ==================== Deep Sleep Configuration ====================
 #define SLEEP_DURATION_SEC 60  // Wake every 60 seconds to update display
 #define WEATHER_UPDATE_MIN 30  // Update weather every 30 minutes
-#define FULL_REFRESH_CYCLES 60 // Full display refresh every 60 wakes (~1 hour)
+// RTC_DATA_ATTR state kept across sleep: 8 KB of RTC slow memory, less the
+// 512 byte ULP reserve and room for the core's own RTC data
+#define RTC_STATE_MAX 7168
 
 // ==================== Remote Mode Configuration ====================
 #define REMOTE_API_URL "http://192.168.1.173:3000/api/display/status"
 #define REMOTE_CHECK_CYCLES 5 // Check every 5 wakes (5 min) in normal mode
 #define REMOTE_REFRESH_SEC 60 // Refresh every 60 sec in remote mode
 
+// ==================== Server Schedule Hints ====================
+// "valid_until"/"next_check" hints from the server are clamped to this range
+#define HINT_MIN_DELAY_SEC 30   // Ignore hints shorter than this
+#define HINT_MAX_DELAY_SEC 3600 // Always check again at least hourly
+
 #endif // CONFIG_H
@@ -2,106 +2,84 @@
 #define DISPLAY_MANAGER_H
 
 #include <Arduino.h>
-#include <GxEPD.h>
-#include <GxDEPG0213BN/GxDEPG0213BN.h>
-#include <GxIO/GxIO_SPI/GxIO_SPI.h>
-#include <GxIO/GxIO.h>
-#include <Fonts/FreeMonoBold9pt7b.h>
-#include <Fonts/FreeMonoBold12pt7b.h>
-#include <Fonts/FreeMonoBold18pt7b.h>
-#include <Fonts/FreeSans9pt7b.h>
-#include <Fonts/FreeSansBold9pt7b.h>
+#include "canvas.h"
 #include "config.h"
+#include "epd_panel.h"
+#include "refresh_scheduler.h"
 
-enum TextAlignment {
-    ALIGN_LEFT = 0,
-    ALIGN_CENTER,
-    ALIGN_RIGHT
-};
-
-class DisplayManager {
+// The canvas plus the e-paper panel it is shown on
+class DisplayManager : public Canvas {
 private:
-    GxIO_Class* io;
-    GxEPD_Class* display;
+    EpdPanel panel;
+    RefreshScheduler* scheduler;
 
 public:
-    DisplayManager() : io(nullptr), display(nullptr) {}
-
-    void begin() {
-        SPI.begin(SPI_CLK, SPI_MISO, SPI_MOSI, ELINK_SS);
-        io = new GxIO_Class(SPI, ELINK_SS, ELINK_DC, ELINK_RESET);
-        display = new GxEPD_Class(*io, ELINK_RESET, ELINK_BUSY);
+    DisplayManager() : scheduler(nullptr) {}
 
-        display->init();
-        display->setRotation(DISPLAY_ROTATION);
-        display->fillScreen(GxEPD_WHITE);
-        display->setTextColor(GxEPD_BLACK);
+    // Refreshes are counted in (and partial ones planned by) this
+    // RTC-resident scheduler; without one every partial stays partial
+    void setRefreshScheduler(RefreshScheduler* sched) {
+        scheduler = sched;
     }
 
-    void clear() {
-        display->fillScreen(GxEPD_WHITE);
+    // initial = true on power-on/reset, false when waking from deep sleep
+    void begin(bool initial = true) {
+        panel.begin(initial);
     }
 
+    // Full refresh of the whole framebuffer
     void update() {
-        display->update();
+        panel.writeFullFrame(frame.getBuffer());
+        if (scheduler) {
+            recordRefresh(*scheduler, REFRESH_FULL, 0, 0, width(), height());
+        }
     }
 
+    // Partial refresh of a logical (rotated) rectangle
     void partialUpdate(int16_t x, int16_t y, int16_t w, int16_t h) {
-        display->updateWindow(x, y, w, h, true);
+        int16_t px, py, pw, ph;
+        frame.toPanelRect(x, y, w, h, &px, &py, &pw, &ph);
+        panel.writePartialWindow(frame.getBuffer(), px, py, pw, ph);
+        panel.powerOff();
+        if (scheduler) {
+            recordRefresh(*scheduler, REFRESH_PARTIAL, x, y, w, h);
+        }
     }
 
-    void setFont(const GFXfont* font) {
-        display->setFont(font);
+    // Partial refresh that flashes the area inverted first, clearing the
+    // ghosting left by earlier partial refreshes
+    void cleanUpdate(int16_t x, int16_t y, int16_t w, int16_t h) {
+        int16_t px, py, pw, ph;
+        frame.toPanelRect(x, y, w, h, &px, &py, &pw, &ph);
+        panel.writePartialWindow(frame.getBuffer(), px, py, pw, ph, true);
+        panel.writePartialWindow(frame.getBuffer(), px, py, pw, ph);
+        panel.powerOff();
+        if (scheduler) {
+            recordRefresh(*scheduler, REFRESH_CLEAN, x, y, w, h);
+        }
     }
 
-    void drawText(const String& text, int16_t y, TextAlignment align) {
-        int16_t x = 0;
-        int16_t x1, y1;
-        uint16_t w, h;
-
-        display->getTextBounds(text, 0, y, &x1, &y1, &w, &h);
+    // How a changed area should be refreshed. For REFRESH_FULL the
+    // framebuffer must hold the whole screen before refresh() is called.
+    RefreshKind planRefresh(int16_t x, int16_t y, int16_t w, int16_t h) {
+        return scheduler ? ::planRefresh(*scheduler, x, y, w, h)
+                         : REFRESH_PARTIAL;
+    }
 
-        switch (align) {
-            case ALIGN_LEFT:
-                x = 2;
+    void refresh(RefreshKind kind, int16_t x, int16_t y, int16_t w,
+                 int16_t h) {
+        switch (kind) {
+            case REFRESH_FULL:
+                update();
                 break;
-            case ALIGN_CENTER:
-                x = (display->width() - w) / 2;
+            case REFRESH_CLEAN:
+                cleanUpdate(x, y, w, h);
                 break;
-            case ALIGN_RIGHT:
-                x = display->width() - w - 2;
+            default:
+                partialUpdate(x, y, w, h);
                 break;
         }
-
-        display->setCursor(x, y);
-        display->print(text);
-    }
-
-    void drawTextAt(const String& text, int16_t x, int16_t y) {
-        display->setCursor(x, y);
-        display->print(text);
     }
-
-    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
-        display->drawLine(x0, y0, x1, y1, GxEPD_BLACK);
-    }
-
-    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h) {
-        display->drawRect(x, y, w, h, GxEPD_BLACK);
-    }
-
-    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, bool black = true) {
-        display->fillRect(x, y, w, h, black ? GxEPD_BLACK : GxEPD_WHITE);
-    }
-
-    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h) {
-        display->drawBitmap(x, y, bitmap, w, h, GxEPD_BLACK);
-    }
-
-    int16_t width() { return display->width(); }
-    int16_t height() { return display->height(); }
-
-    GxEPD_Class* getDisplay() { return display; }
 };
 
 #endif // DISPLAY_MANAGER_H
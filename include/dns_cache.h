@@ -0,0 +1,131 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include "config.h"
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <time.h>
+
+// Tiny resolver cache kept in RTC memory. The lwIP DNS cache is lost in
+// deep sleep, so without this every fetch starts with a DNS round trip.
+// lwIP does not expose record TTLs, so entries live for DNS_CACHE_TTL_SEC.
+
+#define DNS_CACHE_SIZE 4
+#define DNS_HOST_MAX 40
+
+struct DnsCacheEntry {
+  char host[DNS_HOST_MAX];
+  uint32_t ip;      // IPv4 address, network order as stored by IPAddress
+  uint32_t expires; // Local time(nullptr) deadline
+};
+
+// RTC-compatible cache
+struct DnsCache {
+  DnsCacheEntry entries[DNS_CACHE_SIZE];
+};
+
+// Split "http(s)://host[:port]/path" into host and port
+inline bool parseUrlHost(const char *url, char *host, size_t hostLen,
+                         uint16_t *port) {
+  const char *p = strstr(url, "://");
+  if (!p)
+    return false;
+  *port = strncmp(url, "https", 5) == 0 ? 443 : 80;
+  p += 3;
+
+  size_t len = strcspn(p, ":/");
+  if (len == 0 || len >= hostLen)
+    return false;
+  memcpy(host, p, len);
+  host[len] = '\0';
+
+  if (p[len] == ':') {
+    *port = atoi(p + len + 1);
+  }
+  return true;
+}
+
+inline DnsCacheEntry *findDnsEntry(DnsCache &cache, const char *host) {
+  for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+    if (strcmp(cache.entries[i].host, host) == 0)
+      return &cache.entries[i];
+  }
+  return nullptr;
+}
+
+// Resolve host, store it in the cache (replacing the oldest entry)
+inline bool resolveAndCache(DnsCache &cache, const char *host, IPAddress &ip) {
+  if (!WiFi.hostByName(host, ip)) {
+    Serial.printf("DNS: failed to resolve %s\n", host);
+    return false;
+  }
+
+  DnsCacheEntry *entry = findDnsEntry(cache, host);
+  if (!entry) {
+    entry = &cache.entries[0];
+    for (int i = 1; i < DNS_CACHE_SIZE; i++) {
+      if (cache.entries[i].expires < entry->expires)
+        entry = &cache.entries[i];
+    }
+    strncpy(entry->host, host, DNS_HOST_MAX - 1);
+    entry->host[DNS_HOST_MAX - 1] = '\0';
+  }
+  entry->ip = (uint32_t)ip;
+  entry->expires = (uint32_t)time(nullptr) + DNS_CACHE_TTL_SEC;
+
+  Serial.printf("DNS: %s -> %s (cached)\n", host, ip.toString().c_str());
+  return true;
+}
+
+// Open the TCP connection by cached IP, then hand it to HTTPClient with the
+// original URL so the Host header stays correct. Re-resolves only when the
+// entry expired or the cached address does not answer.
+inline bool beginCached(HTTPClient &http, WiFiClient &client, const char *url,
+                        DnsCache &cache) {
+  char host[DNS_HOST_MAX];
+  uint16_t port;
+  IPAddress ip;
+
+  if (!parseUrlHost(url, host, sizeof(host), &port)) {
+    return http.begin(client, url);
+  }
+
+  if (ip.fromString(host)) {
+    // IP literal: nothing to resolve
+    return client.connect(ip, port) && http.begin(client, url);
+  }
+
+  DnsCacheEntry *entry = findDnsEntry(cache, host);
+  bool fresh = entry && entry->ip != 0 &&
+               (uint32_t)time(nullptr) < entry->expires;
+
+  if (fresh) {
+    ip = IPAddress(entry->ip);
+    if (!client.connect(ip, port)) {
+      Serial.printf("DNS: cached address for %s failed, re-resolving\n",
+                    host);
+      fresh = false;
+    }
+  }
+
+  if (!fresh) {
+    if (!resolveAndCache(cache, host, ip) || !client.connect(ip, port)) {
+      return false;
+    }
+  }
+
+  // HTTPClient reuses the already connected client
+  return http.begin(client, url);
+}
+
+// Copy a collected response header into buf ("" if absent). HTTPClient
+// only hands out String copies, so take one and drop it straight away.
+inline const char *copyHttpHeader(HTTPClient &http, const char *name,
+                                  char *buf, size_t size) {
+  strncpy(buf, http.header(name).c_str(), size - 1);
+  buf[size - 1] = '\0';
+  return buf;
+}
+
+#endif // DNS_CACHE_H
@@ -0,0 +1,116 @@
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include "config.h"
+#include "power_profile.h"
+#include <Arduino.h>
+#include <time.h>
+
+// Daily energy ledger. Every wake adds its radio time, HTTP requests,
+// panel refreshes and active-time energy to a 24 h window in RTC memory.
+// The window is tumbling, not rolling: it opens at the first wake, closes
+// once it spans a day (its total becomes "last full day") and a new one
+// starts empty. Sleep current and per-refresh panel charge come from the
+// model in config.h. Once the window holds ENERGY_MIN_WINDOW_SEC of data
+// it is projected to mAh/day and days per charge, so the effect of a
+// scheduling or caching change shows up within hours instead of after a
+// drained battery. The wake simulator ([env:native_sim]) shows it within
+// seconds, on the host.
+
+// Counters for the current wake
+static uint16_t wakeHttpRequests = 0;
+static uint16_t wakeFullRefreshes = 0;
+static uint16_t wakePartialRefreshes = 0;
+
+inline void countHttpRequest() { wakeHttpRequests++; }
+
+inline void countPanelRefresh(bool full) {
+  if (full) {
+    wakeFullRefreshes++;
+  } else {
+    wakePartialRefreshes++;
+  }
+}
+
+// RTC-compatible tumbling window
+struct EnergyLedger {
+  uint32_t windowStart; // time(nullptr) when the window opened (0 = none)
+  uint32_t wakes;
+  uint32_t activeMs;
+  uint32_t radioMs;
+  uint32_t activeUAh; // CPU + radio, from the power profile model
+  uint16_t httpRequests;
+  uint16_t fullRefreshes;
+  uint16_t partialRefreshes;
+  uint16_t lastDayMah10; // Previous complete window, 0.1 mAh units
+};
+
+inline void resetEnergyWindow(EnergyLedger &ledger, uint32_t now) {
+  uint16_t lastDay = ledger.lastDayMah10;
+  memset(&ledger, 0, sizeof(ledger));
+  ledger.windowStart = now;
+  ledger.lastDayMah10 = lastDay;
+}
+
+// Charge used by the window so far in uAh (active + panel + deep sleep)
+inline float windowEnergyUAh(const EnergyLedger &ledger, uint32_t elapsed) {
+  float sleepSec = elapsed - ledger.activeMs / 1000.0;
+  if (sleepSec < 0)
+    sleepSec = 0;
+  float panelMas = ledger.fullRefreshes * POWER_MAS_FULL_REFRESH +
+                   ledger.partialRefreshes * POWER_MAS_PARTIAL_REFRESH;
+  return ledger.activeUAh + panelMas / 3.6 +
+         sleepSec * POWER_MA_SLEEP / 3.6;
+}
+
+// Add this wake to the ledger and print the projection.
+// wakeUAh: active energy of this wake (see reportPowerProfile()).
+inline void reportEnergy(EnergyLedger &ledger, uint32_t wakeUAh) {
+  uint32_t now = time(nullptr);
+
+  // The RTC keeps counting in deep sleep; a jump means the clock was set
+  if (ledger.windowStart == 0 || now < ledger.windowStart ||
+      now - ledger.windowStart > 2 * 86400UL) {
+    resetEnergyWindow(ledger, now);
+  }
+
+  ledger.wakes++;
+  ledger.activeMs += millis();
+  ledger.radioMs += radioOnMs();
+  ledger.activeUAh += wakeUAh;
+  ledger.httpRequests += wakeHttpRequests;
+  ledger.fullRefreshes += wakeFullRefreshes;
+  ledger.partialRefreshes += wakePartialRefreshes;
+
+  uint32_t elapsed = max(now - ledger.windowStart, (uint32_t)1);
+  float mahPerDay = windowEnergyUAh(ledger, elapsed) / 1000.0 *
+                    86400.0 / elapsed;
+
+  Serial.printf("Energy: %lu s window, %lu wakes, active %lu ms, radio %lu "
+                "ms, %u HTTP, %u full/%u partial refreshes\n",
+                (unsigned long)elapsed, (unsigned long)ledger.wakes,
+                (unsigned long)ledger.activeMs, (unsigned long)ledger.radioMs,
+                ledger.httpRequests, ledger.fullRefreshes,
+                ledger.partialRefreshes);
+  // A young window is mostly the wake that opened it, which would project
+  // one wake's active time onto the whole day
+  if (elapsed < ENERGY_MIN_WINDOW_SEC) {
+    Serial.printf("Energy: projection after %lu more s of data",
+                  (unsigned long)(ENERGY_MIN_WINDOW_SEC - elapsed));
+  } else {
+    Serial.printf("Energy: %.2f mAh/day projected, %.0f days per charge",
+                  mahPerDay, BATTERY_CAPACITY_MAH / mahPerDay);
+  }
+  if (ledger.lastDayMah10 > 0) {
+    Serial.printf(" (last full day %.1f mAh)", ledger.lastDayMah10 / 10.0);
+  }
+  Serial.println();
+
+  // Close the window once it covers a day
+  if (elapsed >= 86400UL) {
+    ledger.lastDayMah10 = constrain(mahPerDay * 10, 1, 65535);
+    resetEnergyWindow(ledger, now);
+  }
+}
+
+#endif // ENERGY_MODEL_H
@@ -0,0 +1,216 @@
+#ifndef EPD_PANEL_H
+#define EPD_PANEL_H
+
+#include "config.h"
+#include "energy_model.h"
+#include "frame_buffer.h"
+#include "power_profile.h"
+#include <Arduino.h>
+#include <driver/spi_master.h>
+
+// Low level driver for the GxDEPG0213BN (SSD1680 controller).
+// Pixel data is pushed with ESP32 SPI DMA transactions straight from the
+// framebuffer instead of byte-by-byte transfer() calls.
+
+#define EPD_BUSY_TIMEOUT_MS 10000
+
+class EpdPanel {
+private:
+  spi_device_handle_t spi;
+  // Staging area for windows that are not contiguous in panel RAM
+  uint8_t staging[PANEL_BUFFER_SIZE] __attribute__((aligned(4)));
+
+  void send(const uint8_t *data, size_t len, bool isData) {
+    if (len == 0)
+      return;
+    gpio_set_level((gpio_num_t)ELINK_DC, isData ? 1 : 0);
+
+    spi_transaction_t t = {};
+    t.length = len * 8;
+    if (len <= 4) {
+      // Short command/parameter bytes go through the transaction itself
+      t.flags = SPI_TRANS_USE_TXDATA;
+      memcpy(t.tx_data, data, len);
+      spi_device_polling_transmit(spi, &t);
+    } else {
+      // Bulk pixel data: DMA from the (DMA capable, word aligned) buffer
+      t.tx_buffer = data;
+      spi_device_transmit(spi, &t);
+    }
+  }
+
+  void command(uint8_t c) { send(&c, 1, false); }
+
+  void data(uint8_t d) { send(&d, 1, true); }
+
+  void setRamArea(int16_t x, int16_t y, int16_t w, int16_t h) {
+    command(0x11); // Data entry mode: X increment, Y increment
+    data(0x03);
+    command(0x44); // RAM X start/end (in bytes)
+    data(x / 8);
+    data((x + w - 1) / 8);
+    command(0x45); // RAM Y start/end
+    data(y % 256);
+    data(y / 256);
+    data((y + h - 1) % 256);
+    data((y + h - 1) / 256);
+    command(0x4E); // RAM X counter
+    data(x / 8);
+    command(0x4F); // RAM Y counter
+    data(y % 256);
+    data(y / 256);
+  }
+
+  void initController() {
+    command(0x12); // Software reset (RAM content is kept)
+    delay(10);
+    waitWhileBusy();
+
+    command(0x01); // Driver output control: 250 gates
+    data((PANEL_HEIGHT - 1) % 256);
+    data((PANEL_HEIGHT - 1) / 256);
+    data(0x00);
+    command(0x3C); // Border waveform
+    data(0x05);
+    command(0x21); // Display update control
+    data(0x00);
+    data(0x80);
+    command(0x18); // Internal temperature sensor
+    data(0x80);
+  }
+
+  void activate(uint8_t sequence) {
+    command(0x22);
+    data(sequence);
+    command(0x20);
+    waitWhileBusy();
+  }
+
+public:
+  EpdPanel() : spi(nullptr) {}
+
+  // initial = true on power-on: hardware reset of the controller.
+  // After deep sleep the controller keeps its RAM (we never hibernate it),
+  // which is what makes partial updates across wakes possible.
+  bool begin(bool initial) {
+    pinMode(ELINK_DC, OUTPUT);
+    pinMode(ELINK_RESET, OUTPUT);
+    pinMode(ELINK_BUSY, INPUT);
+    digitalWrite(ELINK_RESET, HIGH);
+
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = SPI_MOSI;
+    bus.miso_io_num = SPI_MISO;
+    bus.sclk_io_num = SPI_CLK;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = PANEL_BUFFER_SIZE;
+
+    // VSPI is dedicated to the panel (the SD card uses its own pins)
+    if (spi_bus_initialize(SPI3_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK) {
+      Serial.println("EPD: SPI bus init failed");
+      return false;
+    }
+
+    spi_device_interface_config_t dev = {};
+    dev.clock_speed_hz = EPD_SPI_FREQUENCY;
+    dev.mode = 0;
+    dev.spics_io_num = ELINK_SS;
+    dev.queue_size = 1;
+    dev.flags = SPI_DEVICE_HALFDUPLEX;
+
+    if (spi_bus_add_device(SPI3_HOST, &dev, &spi) != ESP_OK) {
+      Serial.println("EPD: SPI device add failed");
+      return false;
+    }
+
+    if (initial) {
+      digitalWrite(ELINK_RESET, LOW);
+      delay(10);
+      digitalWrite(ELINK_RESET, HIGH);
+      delay(10);
+    }
+
+    return true;
+  }
+
+  void waitWhileBusy() {
+    if (digitalRead(ELINK_BUSY) != HIGH)
+      return;
+    PowerPhase previous = setPowerPhase(PHASE_DISPLAY_WAIT);
+    unsigned long start = millis();
+    while (digitalRead(ELINK_BUSY) == HIGH) {
+      if (millis() - start > EPD_BUSY_TIMEOUT_MS) {
+        Serial.println("EPD: busy timeout");
+        break;
+      }
+      delay(1);
+    }
+    setPowerPhase(previous);
+  }
+
+  // Write a full framebuffer to both controller RAMs and do a full refresh
+  void writeFullFrame(const uint8_t *frame) {
+    countPanelRefresh(true);
+    initController();
+    setRamArea(0, 0, PANEL_ROW_BYTES * 8, PANEL_HEIGHT);
+    command(0x26); // Previous image RAM
+    send(frame, PANEL_BUFFER_SIZE, true);
+    setRamArea(0, 0, PANEL_ROW_BYTES * 8, PANEL_HEIGHT);
+    command(0x24); // New image RAM
+    send(frame, PANEL_BUFFER_SIZE, true);
+
+    activate(0xF7); // Power on, load LUT, full refresh, power off
+  }
+
+  // Write a window (native panel coordinates, x/w byte aligned) to the new
+  // image RAM and do a partial refresh, then sync the previous image RAM.
+  // invert: send the window inverted (first half of a clean refresh).
+  void writePartialWindow(const uint8_t *frame, int16_t x, int16_t y,
+                          int16_t w, int16_t h, bool invert = false) {
+    if (w <= 0 || h <= 0)
+      return;
+    countPanelRefresh(false);
+
+    const uint8_t *src;
+    size_t len;
+    int16_t xBytes = x / 8;
+    int16_t wBytes = w / 8;
+
+    if (wBytes == PANEL_ROW_BYTES && !invert) {
+      // Full-width window is contiguous in the framebuffer
+      src = frame + y * PANEL_ROW_BYTES;
+      len = (size_t)h * PANEL_ROW_BYTES;
+    } else {
+      for (int16_t row = 0; row < h; row++) {
+        memcpy(staging + row * wBytes,
+               frame + (y + row) * PANEL_ROW_BYTES + xBytes, wBytes);
+      }
+      if (invert) {
+        for (size_t i = 0; i < (size_t)h * wBytes; i++) {
+          staging[i] = ~staging[i];
+        }
+      }
+      src = staging;
+      len = (size_t)h * wBytes;
+    }
+
+    command(0x3C); // Border: keep during partial refresh
+    data(0x80);
+
+    setRamArea(x, y, w, h);
+    command(0x24);
+    send(src, len, true);
+
+    activate(0xFC); // Partial refresh, keep analog on
+
+    setRamArea(x, y, w, h);
+    command(0x26);
+    send(src, len, true);
+  }
+
+  // Turn off the booster/analog supply but keep RAM for the next wake
+  void powerOff() { activate(0x83); }
+};
+
+#endif // EPD_PANEL_H
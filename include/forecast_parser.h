@@ -0,0 +1,78 @@
+#ifndef FORECAST_PARSER_H
+#define FORECAST_PARSER_H
+
+#include "json_arena.h"
+#include "weather_data.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// forecast.json (WeatherAPI) to WeatherData. Kept apart from the fetch
+// code (weather.h) so the host benchmarks can run it without HTTP.
+
+#define WEATHER_ARENA_SIZE 8192 // Filtered forecast.json document
+
+// Parse a forecast.json response (body text or the HTTP stream) into
+// weather. Only the fields used below are kept, and the document lives in
+// the arena, so a full forecast does not touch the heap. weather is left
+// untouched if the response does not parse.
+template <typename TInput>
+inline bool parseForecast(TInput &&payload, JsonArena &arena,
+                          WeatherData &weather) {
+  arena.reset();
+  JsonDocument filter(&arena);
+  filter["current"]["temp_c"] = true;
+  filter["current"]["feelslike_c"] = true;
+  filter["current"]["humidity"] = true;
+  filter["current"]["condition"]["text"] = true;
+  filter["current"]["condition"]["icon"] = true;
+  filter["current"]["is_day"] = true;
+  JsonObject dayFilter = filter["forecast"]["forecastday"][0]["day"];
+  dayFilter["daily_chance_of_rain"] = true;
+  dayFilter["maxtemp_c"] = true;
+  dayFilter["mintemp_c"] = true;
+  dayFilter["condition"]["text"] = true;
+
+  JsonDocument doc(&arena);
+  DeserializationError error = deserializeJson(
+      doc, payload, DeserializationOption::Filter(filter));
+  if (arena.fallbacks > 0) {
+    Serial.printf("Weather: JSON arena full (%u heap allocations)\n",
+                  arena.fallbacks);
+  }
+  if (error) {
+    return false;
+  }
+
+  // Current weather
+  weather.temperature = doc["current"]["temp_c"];
+  weather.feelsLike = doc["current"]["feelslike_c"];
+  weather.humidity = doc["current"]["humidity"];
+
+  // Copy strings to fixed-size buffers
+  const char *condText = doc["current"]["condition"]["text"];
+  strncpy(weather.condition, condText ? condText : "",
+          sizeof(weather.condition) - 1);
+  weather.condition[sizeof(weather.condition) - 1] = '\0';
+
+  const char *iconText = doc["current"]["condition"]["icon"];
+  strncpy(weather.icon, iconText ? iconText : "", sizeof(weather.icon) - 1);
+  weather.icon[sizeof(weather.icon) - 1] = '\0';
+
+  weather.isDay = doc["current"]["is_day"] == 1;
+
+  // Forecast data for today
+  JsonObject forecastDay = doc["forecast"]["forecastday"][0]["day"];
+  weather.chanceOfRain = forecastDay["daily_chance_of_rain"];
+  weather.maxTemp = forecastDay["maxtemp_c"];
+  weather.minTemp = forecastDay["mintemp_c"];
+
+  const char *forecastText = forecastDay["condition"]["text"];
+  strncpy(weather.forecastCondition, forecastText ? forecastText : "",
+          sizeof(weather.forecastCondition) - 1);
+  weather.forecastCondition[sizeof(weather.forecastCondition) - 1] = '\0';
+
+  weather.valid = true;
+  return true;
+}
+
+#endif // FORECAST_PARSER_H
@@ -0,0 +1,162 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include "config.h"
+#include <Adafruit_GFX.h>
+#include <string.h>
+
+// The panel's two colors (names and values from the GxEPD driver that
+// epd_panel.h replaced)
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
+
+// Native (unrotated) panel geometry. The panel is portrait; with
+// DISPLAY_ROTATION 1 the logical 250x122 screen maps onto 122x250 panel RAM.
+#define PANEL_WIDTH DISPLAY_HEIGHT
+#define PANEL_HEIGHT DISPLAY_WIDTH
+#define PANEL_ROW_BYTES ((PANEL_WIDTH + 7) / 8)               // 16 bytes
+#define PANEL_BUFFER_SIZE (PANEL_ROW_BYTES * PANEL_HEIGHT)    // 4000 bytes
+
+// 1bpp framebuffer laid out exactly like the controller RAM
+// (MSB first, 1 = white, rows of PANEL_ROW_BYTES), so it can be sent to the
+// panel in a single SPI transfer without any per-pixel conversion.
+class FrameBuffer : public Adafruit_GFX {
+private:
+  uint8_t buffer[PANEL_BUFFER_SIZE] __attribute__((aligned(4)));
+
+public:
+  FrameBuffer() : Adafruit_GFX(PANEL_WIDTH, PANEL_HEIGHT) {
+    memset(buffer, 0xFF, sizeof(buffer));
+  }
+
+  // Map logical (rotated) coordinates to native panel coordinates.
+  // Same rotation mapping as the GxEPD driver for this panel.
+  void toPanel(int16_t x, int16_t y, int16_t *nx, int16_t *ny) const {
+    switch (getRotation()) {
+    case 1:
+      *nx = PANEL_WIDTH - y - 1;
+      *ny = x;
+      break;
+    case 2:
+      *nx = PANEL_WIDTH - x - 1;
+      *ny = PANEL_HEIGHT - y - 1;
+      break;
+    case 3:
+      *nx = y;
+      *ny = PANEL_HEIGHT - x - 1;
+      break;
+    default:
+      *nx = x;
+      *ny = y;
+      break;
+    }
+  }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= width() || y >= height())
+      return;
+
+    int16_t nx, ny;
+    toPanel(x, y, &nx, &ny);
+
+    uint8_t *p = &buffer[ny * PANEL_ROW_BYTES + nx / 8];
+    uint8_t mask = 0x80 >> (nx & 7);
+    if (color == GxEPD_BLACK) {
+      *p &= ~mask;
+    } else {
+      *p |= mask;
+    }
+  }
+
+  void fillScreen(uint16_t color) override {
+    memset(buffer, color == GxEPD_BLACK ? 0x00 : 0xFF, sizeof(buffer));
+  }
+
+  // Convert a logical (rotated) rectangle to native panel coordinates,
+  // widened so x and w are byte aligned as the controller RAM requires.
+  void toPanelRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t *px,
+                   int16_t *py, int16_t *pw, int16_t *ph) const {
+    int16_t nx = x, ny = y, nw = w, nh = h;
+    switch (getRotation()) {
+    case 1:
+      nx = PANEL_WIDTH - (y + h);
+      ny = x;
+      nw = h;
+      nh = w;
+      break;
+    case 2:
+      nx = PANEL_WIDTH - (x + w);
+      ny = PANEL_HEIGHT - (y + h);
+      break;
+    case 3:
+      nx = y;
+      ny = PANEL_HEIGHT - (x + w);
+      nw = h;
+      nh = w;
+      break;
+    }
+
+    // Clip to panel
+    if (nx < 0) {
+      nw += nx;
+      nx = 0;
+    }
+    if (ny < 0) {
+      nh += ny;
+      ny = 0;
+    }
+    if (nx + nw > PANEL_WIDTH)
+      nw = PANEL_WIDTH - nx;
+    if (ny + nh > PANEL_HEIGHT)
+      nh = PANEL_HEIGHT - ny;
+
+    // Byte align horizontally
+    int16_t x0 = nx & ~7;
+    int16_t x1 = (nx + nw + 7) & ~7;
+    *px = x0;
+    *py = ny;
+    *pw = nw > 0 ? x1 - x0 : 0;
+    *ph = nh > 0 ? nh : 0;
+  }
+
+  // Copy a full image that is already in panel RAM layout.
+  // invert = true when the image uses 1 for black.
+  void blitPanelImage(const uint8_t *image, bool invert) {
+    if (!invert) {
+      memcpy(buffer, image, PANEL_BUFFER_SIZE);
+      return;
+    }
+    // Both buffers are word aligned; invert 32 bits at a time
+    const uint32_t *src = (const uint32_t *)image;
+    uint32_t *dst = (uint32_t *)buffer;
+    for (size_t i = 0; i < PANEL_BUFFER_SIZE / 4; i++) {
+      dst[i] = ~src[i];
+    }
+  }
+
+  // Copy a full screen row-major image (logical orientation, rows padded to
+  // whole bytes) into panel layout without going through drawPixel().
+  void blitRowImage(const uint8_t *image, bool invert) {
+    const int16_t rowBytes = (width() + 7) / 8;
+    uint8_t flip = invert ? 0xFF : 0x00;
+    memset(buffer, 0xFF, sizeof(buffer));
+
+    for (int16_t y = 0; y < height(); y++) {
+      const uint8_t *row = image + y * rowBytes;
+      for (int16_t x = 0; x < width(); x++) {
+        uint8_t bits = row[x / 8] ^ flip;
+        if (bits & (0x80 >> (x & 7)))
+          continue; // white, already set
+
+        int16_t nx, ny;
+        toPanel(x, y, &nx, &ny);
+        buffer[ny * PANEL_ROW_BYTES + nx / 8] &= ~(0x80 >> (nx & 7));
+      }
+    }
+  }
+
+  uint8_t *getBuffer() { return buffer; }
+  const uint8_t *getBuffer() const { return buffer; }
+};
+
+#endif // FRAME_BUFFER_H
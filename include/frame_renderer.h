@@ -0,0 +1,88 @@
+#ifndef FRAME_RENDERER_H
+#define FRAME_RENDERER_H
+
+#include "canvas.h"
+#include "config.h"
+#include "icons.h"
+#include "json_arena.h"
+#include "time_manager.h"
+#include "weather_data.h"
+#include "weather_view.h"
+#include "widgets.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Frame renderer for the remote-mode backend: draws a JSON render request
+// with the same widget code, fonts and layout as the main screen, so a
+// server can pre-render frames in bulk that the device only has to blit.
+// Drawing only (no panel, WiFi or clock): built on the host by
+// [env:native_render] (src/host/render_cli.cpp) and driven by
+// tools/render_frames.py.
+//
+// Request (one line, every field optional):
+// {"time": 1718000000, "wifi": true, "battery": 80, "charging": false,
+//  "message": "Bom dia!", "morning": true,
+//  "weather": {"temp": 14.0, "feels_like": 13.4, "humidity": 88,
+//              "condition": "Parcialmente nublado", "is_day": false,
+//              "rain": 12, "min": 12.9, "max": 22.4}}
+//
+// The image is left in the canvas framebuffer, in panel RAM layout (send
+// it with "layout": "panel").
+
+#define RENDER_LINE_MAX 1024
+#define RENDER_ARENA_SIZE 2048
+
+// Weather as sent by the backend (flat, already in device units)
+inline void readRenderWeather(JsonObject json, WeatherData &data) {
+  memset(&data, 0, sizeof(data));
+  if (json.isNull())
+    return;
+  data.temperature = json["temp"] | 0.0f;
+  data.feelsLike = json["feels_like"] | data.temperature;
+  data.humidity = json["humidity"] | 0;
+  strncpy(data.condition, json["condition"] | "",
+          sizeof(data.condition) - 1);
+  strncpy(data.forecastCondition, json["forecast_condition"] | "",
+          sizeof(data.forecastCondition) - 1);
+  data.isDay = json["is_day"] | true;
+  data.chanceOfRain = json["rain"] | 0;
+  data.minTemp = json["min"] | data.temperature;
+  data.maxTemp = json["max"] | data.temperature;
+  data.valid = true;
+}
+
+// Render one request into the framebuffer. Returns an error or nullptr.
+inline const char *renderFrame(Canvas &display, JsonArena &arena,
+                               const char *line) {
+  arena.reset();
+  JsonDocument doc(&arena);
+  if (deserializeJson(doc, line))
+    return "bad json";
+
+  // Clock and date widgets read the formatted strings
+  uint32_t at = doc["time"] | 0UL;
+  updateTimeStrings(at > 0 ? (time_t)at : time(nullptr));
+
+  WeatherData data;
+  readRenderWeather(doc["weather"], data);
+  static WeatherView view;
+  buildWeatherView(display, data, view);
+
+  int battery = doc["battery"] | 100;
+  const unsigned char *batteryIcon = (doc["charging"] | false)
+                                         ? icon_battery_charging
+                                         : getBatteryIcon(battery);
+  ScreenData screen = makeScreenData(view, doc["morning"] | true,
+                                     doc["wifi"] | true, batteryIcon);
+  const char *message = doc["message"];
+  if (message) {
+    screen.message = message; // Font picked when drawn
+    screen.morningMessage = true;
+  }
+
+  display.clear();
+  renderWidgets(display, screen, ALL_WIDGETS);
+  return nullptr;
+}
+
+#endif // FRAME_RENDERER_H
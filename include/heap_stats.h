@@ -0,0 +1,93 @@
+#ifndef HEAP_STATS_H
+#define HEAP_STATS_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+// Heap allocation counters. Built with HEAP_ACCOUNTING and the linker
+// wrapping malloc/calloc/realloc/free (see [env:pico32_heap] and
+// [env:native_bench] in platformio.ini), every allocation made by the
+// firmware, the Arduino core and libraries is counted (on the host: by our
+// code and the statically linked libraries). Without it the counters stay
+// at zero.
+
+struct HeapStats {
+  uint32_t allocs;
+  uint32_t frees;
+  uint32_t bytes;
+};
+
+#ifdef HEAP_ACCOUNTING
+static volatile uint32_t heapAllocCount = 0;
+static volatile uint32_t heapFreeCount = 0;
+static volatile uint32_t heapAllocBytes = 0;
+
+// Definitions for the --wrap linker flags (this header is only included
+// from one file per program, main.cpp or bench_cli.cpp, so they are
+// defined once)
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+  heapAllocCount++;
+  heapAllocBytes += size;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+  heapAllocCount++;
+  heapAllocBytes += n * size;
+  return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  heapAllocCount++;
+  heapAllocBytes += size;
+  return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+  if (ptr)
+    heapFreeCount++;
+  __real_free(ptr);
+}
+}
+#endif
+
+inline HeapStats heapStatsNow() {
+#ifdef HEAP_ACCOUNTING
+  HeapStats stats = {heapAllocCount, heapFreeCount, heapAllocBytes};
+#else
+  HeapStats stats = {0, 0, 0};
+#endif
+  return stats;
+}
+
+// Allocations since an earlier snapshot
+inline HeapStats heapStatsSince(const HeapStats &start) {
+  HeapStats now = heapStatsNow();
+  HeapStats delta = {now.allocs - start.allocs, now.frees - start.frees,
+                     now.bytes - start.bytes};
+  return delta;
+}
+
+// Per-wake heap report: allocations since wakeStart (with accounting),
+// lowest free heap since boot and the largest free block. A largest block
+// well below the free total means the heap is fragmenting.
+inline void reportHeap(const HeapStats &wakeStart) {
+#ifdef HEAP_ACCOUNTING
+  HeapStats wake = heapStatsSince(wakeStart);
+  Serial.printf("Heap: %lu allocs, %lu frees, %lu bytes this wake\n",
+                (unsigned long)wake.allocs, (unsigned long)wake.frees,
+                (unsigned long)wake.bytes);
+#endif
+  Serial.printf("Heap: %u free, %u min free, %u largest block\n",
+                heap_caps_get_free_size(MALLOC_CAP_8BIT),
+                heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+                heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
+
+#endif // HEAP_STATS_H
@@ -92,56 +92,70 @@ enum WeatherIconType {
   ICON_FOG
 };
 
-// Get icon based on condition and day/night
-const unsigned char *getWeatherIcon(const char *condition, bool isDay) {
-  // Convert to lowercase for comparison
-  String cond = condition;
-  cond.toLowerCase();
+// Icon bitmaps, indexed by WeatherIconType
+const unsigned char *const WEATHER_ICONS[] = {
+    icon_sunny,         icon_moon,    icon_cloudy, icon_rain,
+    icon_partly_cloudy, icon_thunder, icon_snow,   icon_fog};
+
+// Get icon type based on condition and day/night
+WeatherIconType getWeatherIconType(const char *condition, bool isDay) {
+  // Lowercase copy for comparison (conditions are stored in 16 bytes)
+  char cond[16];
+  size_t len = 0;
+  for (; condition[len] && len < sizeof(cond) - 1; len++) {
+    cond[len] = tolower((unsigned char)condition[len]);
+  }
+  cond[len] = '\0';
 
   // Rain conditions
-  if (cond.indexOf("chuva") >= 0 || cond.indexOf("rain") >= 0 ||
-      cond.indexOf("chuvisco") >= 0 || cond.indexOf("drizzle") >= 0) {
-    return icon_rain;
+  if (strstr(cond, "chuva") || strstr(cond, "rain") ||
+      strstr(cond, "chuvisco") || strstr(cond, "drizzle")) {
+    return ICON_RAIN;
   }
 
   // Thunder
-  if (cond.indexOf("trovoada") >= 0 || cond.indexOf("thunder") >= 0 ||
-      cond.indexOf("raio") >= 0) {
-    return icon_thunder;
+  if (strstr(cond, "trovoada") || strstr(cond, "thunder") ||
+      strstr(cond, "raio")) {
+    return ICON_THUNDER;
   }
 
   // Snow
-  if (cond.indexOf("neve") >= 0 || cond.indexOf("snow") >= 0 ||
-      cond.indexOf("gelo") >= 0 || cond.indexOf("ice") >= 0) {
-    return icon_snow;
+  if (strstr(cond, "neve") || strstr(cond, "snow") ||
+      strstr(cond, "gelo") || strstr(cond, "ice")) {
+    return ICON_SNOW;
   }
 
   // Fog/Mist
-  if (cond.indexOf("nevoeiro") >= 0 || cond.indexOf("fog") >= 0 ||
-      cond.indexOf("neblina") >= 0 || cond.indexOf("mist") >= 0) {
-    return icon_fog;
+  if (strstr(cond, "nevoeiro") || strstr(cond, "fog") ||
+      strstr(cond, "neblina") || strstr(cond, "mist")) {
+    return ICON_FOG;
   }
 
   // Cloudy
-  if (cond.indexOf("nublado") >= 0 || cond.indexOf("cloudy") >= 0 ||
-      cond.indexOf("encoberto") >= 0 || cond.indexOf("overcast") >= 0) {
-    return icon_cloudy;
+  if (strstr(cond, "nublado") || strstr(cond, "cloudy") ||
+      strstr(cond, "encoberto") || strstr(cond, "overcast")) {
+    return ICON_CLOUDY;
   }
 
   // Partly cloudy
-  if (cond.indexOf("parcialmente") >= 0 || cond.indexOf("partly") >= 0) {
-    return icon_partly_cloudy;
+  if (strstr(cond, "parcialmente") || strstr(cond, "partly")) {
+    return ICON_PARTLY_CLOUDY;
   }
 
   // Clear/Sunny - check day or night
-  if (cond.indexOf("sol") >= 0 || cond.indexOf("sunny") >= 0 ||
-      cond.indexOf("limpo") >= 0 || cond.indexOf("clear") >= 0 ||
-      cond.indexOf("ensolarado") >= 0) {
-    return isDay ? icon_sunny : icon_moon;
+  if (strstr(cond, "sol") || strstr(cond, "sunny") ||
+      strstr(cond, "limpo") || strstr(cond, "clear") ||
+      strstr(cond, "ensolarado")) {
+    return isDay ? ICON_SUNNY : ICON_MOON;
   }
 
   // Default based on day/night
-  return isDay ? icon_sunny : icon_moon;
+  return isDay ? ICON_SUNNY : ICON_MOON;
+}
+
+// Get icon based on condition and day/night
+const unsigned char *getWeatherIcon(const char *condition, bool isDay) {
+  return WEATHER_ICONS[getWeatherIconType(condition, isDay)];
 }
 
 // ==================== Status Bar Icons (small) ====================
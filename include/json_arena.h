@@ -0,0 +1,96 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Bump allocator for ArduinoJson documents on the wake path. Memory comes
+// from a static buffer that is reset before each parse, so a parse leaves
+// nothing behind on the heap to fragment it. Requests that do not fit fall
+// back to malloc (counted in fallbacks).
+//
+// Each block has an 8-byte header holding its size. Freeing or resizing
+// the most recent block is done in place; other frees are reclaimed by
+// reset().
+
+#define JSON_ARENA_HEADER 8
+
+class JsonArena : public ArduinoJson::Allocator {
+private:
+  uint8_t *buffer;
+  size_t size;
+  size_t used;
+  size_t last; // Offset of the most recent block (size = none)
+
+  bool owns(void *ptr) const {
+    return (uint8_t *)ptr >= buffer && (uint8_t *)ptr < buffer + size;
+  }
+
+  static size_t align(size_t n) { return (n + 7) & ~(size_t)7; }
+
+  static uint32_t &blockSize(void *ptr) {
+    return *(uint32_t *)((uint8_t *)ptr - JSON_ARENA_HEADER);
+  }
+
+public:
+  uint16_t fallbacks; // Requests that went to the heap since reset()
+  size_t peak;        // Most arena bytes in use since reset()
+
+  JsonArena(uint8_t *buffer, size_t size) : buffer(buffer), size(size) {
+    reset();
+  }
+
+  void reset() {
+    used = 0;
+    last = size;
+    fallbacks = 0;
+    peak = 0;
+  }
+
+  void *allocate(size_t n) override {
+    n = align(n);
+    if (used + JSON_ARENA_HEADER + n > size) {
+      fallbacks++;
+      return malloc(n);
+    }
+    last = used;
+    uint8_t *ptr = buffer + used + JSON_ARENA_HEADER;
+    used += JSON_ARENA_HEADER + n;
+    peak = max(peak, used);
+    blockSize(ptr) = n;
+    return ptr;
+  }
+
+  void deallocate(void *ptr) override {
+    if (!owns(ptr)) {
+      free(ptr);
+    } else if ((uint8_t *)ptr == buffer + last + JSON_ARENA_HEADER) {
+      used = last; // Most recent block: give it back
+      last = size;
+    }
+  }
+
+  void *reallocate(void *ptr, size_t n) override {
+    if (!owns(ptr))
+      return realloc(ptr, n);
+
+    n = align(n);
+    if ((uint8_t *)ptr == buffer + last + JSON_ARENA_HEADER &&
+        last + JSON_ARENA_HEADER + n <= size) {
+      // Most recent block grows or shrinks in place
+      used = last + JSON_ARENA_HEADER + n;
+      peak = max(peak, used);
+      blockSize(ptr) = n;
+      return ptr;
+    }
+    if (n <= blockSize(ptr))
+      return ptr;
+
+    void *moved = allocate(n);
+    if (moved)
+      memcpy(moved, ptr, blockSize(ptr));
+    return moved;
+  }
+};
+
+#endif // JSON_ARENA_H
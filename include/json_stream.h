@@ -0,0 +1,210 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <Arduino.h>
+#include <mbedtls/base64.h>
+
+// Incremental reader for large JSON bodies (remote mode batches). The
+// caller walks the top-level object key by key straight off the socket:
+// small values are copied out as JSON text (and parsed with ArduinoJson
+// in an arena), big base64 strings are decoded chunk by chunk into their
+// destination. The whole body is never held in memory, so a batch of
+// frames costs a few hundred bytes of buffers instead of its own size.
+
+#define JSON_STREAM_BUFFER 256
+#define JSON_STREAM_TIMEOUT_MS 10000 // Longest wait for the next bytes
+#define JSON_BASE64_CHUNK 64         // Multiple of 4
+
+class JsonStreamReader {
+private:
+  Stream &stream;
+  uint8_t buffer[JSON_STREAM_BUFFER];
+  size_t pos;
+  size_t len;
+  bool failed;
+
+  bool fill() {
+    unsigned long start = millis();
+    int available;
+    while ((available = stream.available()) <= 0) {
+      if (millis() - start > JSON_STREAM_TIMEOUT_MS) {
+        failed = true;
+        return false;
+      }
+      delay(1);
+    }
+    len = stream.readBytes(buffer, min((size_t)available, sizeof(buffer)));
+    pos = 0;
+    failed = len == 0;
+    return !failed;
+  }
+
+  static bool isDelimiter(int c) {
+    return c == ',' || c == '}' || c == ']' || isspace(c);
+  }
+
+  // Append one char to out (nullptr: skip). False when out is full.
+  static bool put(char *out, size_t size, size_t *used, int c) {
+    if (!out)
+      return true;
+    if (*used + 1 >= size)
+      return false;
+    out[(*used)++] = c;
+    out[*used] = '\0';
+    return true;
+  }
+
+public:
+  explicit JsonStreamReader(Stream &stream)
+      : stream(stream), pos(0), len(0), failed(false) {}
+
+  // Next char without consuming it (-1 at the end of the data)
+  int peek() {
+    if (failed || (pos >= len && !fill()))
+      return -1;
+    return buffer[pos];
+  }
+
+  int read() {
+    int c = peek();
+    if (c >= 0)
+      pos++;
+    return c;
+  }
+
+  // False once the stream timed out or the JSON was malformed
+  bool ok() const { return !failed; }
+
+  bool fail() {
+    failed = true;
+    return false;
+  }
+
+  // Next non-whitespace char, not consumed
+  int skipSpace() {
+    int c;
+    while ((c = peek()) >= 0 && isspace(c)) {
+      pos++;
+    }
+    return c;
+  }
+
+  bool expect(char c) { return skipSpace() == c ? read() == c : fail(); }
+
+  // Start of an object or array: false (and consumed) if it is empty
+  bool enter(char open, char close) {
+    if (!expect(open))
+      return false;
+    if (skipSpace() == close) {
+      read();
+      return false;
+    }
+    return true;
+  }
+
+  // After a member or element: true if another one follows
+  bool next(char close) {
+    int c = skipSpace();
+    read();
+    if (c == ',')
+      return true;
+    if (c != close)
+      fail();
+    return false;
+  }
+
+  // Object key and its ':'. Keys longer than size are truncated.
+  bool readKey(char *key, size_t size) {
+    size_t used = 0;
+    key[0] = '\0';
+    if (!expect('"'))
+      return false;
+    int c;
+    while ((c = read()) >= 0 && c != '"') {
+      if (c == '\\')
+        c = read();
+      if (used + 1 < size) {
+        key[used++] = c;
+        key[used] = '\0';
+      }
+    }
+    return c == '"' && expect(':');
+  }
+
+  // Copy the next value as JSON text into out, appending at *used
+  // (nullptr: skip it). False if it did not fit or was malformed.
+  bool copyValue(char *out = nullptr, size_t size = 0, size_t *used = nullptr) {
+    size_t skipped = 0;
+    if (!used)
+      used = &skipped;
+    int c = skipSpace();
+    if (c < 0)
+      return fail();
+
+    if (c != '"' && c != '{' && c != '[') {
+      // Number or literal, up to the next delimiter
+      while ((c = peek()) >= 0 && !isDelimiter(c)) {
+        if (!put(out, size, used, read()))
+          return false;
+      }
+      return ok();
+    }
+
+    int depth = 0;
+    bool inString = false;
+    while ((c = read()) >= 0) {
+      if (!put(out, size, used, c))
+        return false;
+      if (inString) {
+        if (c == '\\') {
+          if ((c = read()) < 0 || !put(out, size, used, c))
+            return false;
+        } else if (c == '"') {
+          inString = false;
+          if (depth == 0)
+            return true;
+        }
+      } else if (c == '"') {
+        inString = true;
+      } else if (c == '{' || c == '[') {
+        depth++;
+      } else if ((c == '}' || c == ']') && --depth == 0) {
+        return true;
+      }
+    }
+    return fail();
+  }
+
+  // Decode a base64 string value into dest (maxSize bytes). The string
+  // is always consumed; false if it was not valid base64 or too large.
+  bool readBase64(uint8_t *dest, size_t maxSize, size_t *size) {
+    unsigned char chunk[JSON_BASE64_CHUNK];
+    size_t pending = 0;
+    bool valid = true;
+    *size = 0;
+    if (!expect('"'))
+      return false;
+
+    int c;
+    while ((c = read()) >= 0) {
+      if (c == '"' || pending == sizeof(chunk)) {
+        size_t n = 0;
+        if (valid && pending > 0 &&
+            mbedtls_base64_decode(dest + *size, maxSize - *size, &n, chunk,
+                                  pending) != 0) {
+          valid = false;
+        }
+        *size += n;
+        pending = 0;
+        if (c == '"')
+          return valid;
+      }
+      if (c != '\\') { // "\/" from some JSON encoders
+        chunk[pending++] = c;
+      }
+    }
+    return fail();
+  }
+};
+
+#endif // JSON_STREAM_H
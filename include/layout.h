@@ -0,0 +1,172 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "config.h"
+#include "canvas.h"
+#include "icons.h"
+
+// Main screen layout. Each widget has fixed bounds, a font, an alignment
+// and the data it shows. ui.h computes a cheap key per data source on
+// every wake and only redraws (and partially refreshes) the widgets whose
+// key differs from the one kept in RTC memory.
+//
+// The table is picked at compile time from DISPLAY_WIDTH/DISPLAY_HEIGHT;
+// add a table below to support another panel size.
+
+// Sources up to SOURCE_MESSAGE come from the weather data
+enum WidgetSource : uint8_t {
+  SOURCE_WEATHER_ICON = 0,
+  SOURCE_TEMPERATURE,
+  SOURCE_CONDITION,
+  SOURCE_MIN_MAX,
+  SOURCE_RAIN,
+  SOURCE_MESSAGE,
+  SOURCE_SEPARATOR,
+  SOURCE_TIME,
+  SOURCE_DATE,
+  SOURCE_STATUS, // WiFi + battery
+  WIDGET_SOURCE_COUNT
+};
+
+struct WidgetRect {
+  int16_t x, y, w, h; // Logical (rotated) coordinates
+};
+
+struct WidgetLayout {
+  WidgetSource source;
+  WidgetRect bounds;       // Everything the widget can draw lies in here
+  int16_t baseline;        // Text baseline (text widgets)
+  const GFXfont *font;     // nullptr for bitmaps and lines
+  const GFXfont *longFont; // Used when text is wider than the bounds
+  TextAlignment align;     // Within the bounds
+};
+
+#if DISPLAY_WIDTH == 250 && DISPLAY_HEIGHT == 122
+// 2.13" (GxDEPG0213BN)
+constexpr WidgetLayout MAIN_LAYOUT[] = {
+    {SOURCE_WEATHER_ICON, {2, 2, ICON_WIDTH, ICON_HEIGHT}, 0, nullptr,
+     nullptr, ALIGN_LEFT},
+    {SOURCE_TEMPERATURE, {48, 4, 100, 30}, 30, &FreeMonoBold18pt7b, nullptr,
+     ALIGN_LEFT},
+    {SOURCE_CONDITION, {48, 34, 100, 19}, 48, &FreeSans9pt7b, nullptr,
+     ALIGN_LEFT},
+    {SOURCE_MIN_MAX, {150, 16, 98, 18}, 30, &FreeSans9pt7b, nullptr,
+     ALIGN_LEFT},
+    {SOURCE_RAIN, {150, 34, 98, 19}, 48, &FreeSans9pt7b, nullptr,
+     ALIGN_LEFT},
+    {SOURCE_MESSAGE, {0, 54, 250, 21}, 68, &FreeSansBold9pt7b,
+     &FreeSans9pt7b, ALIGN_CENTER},
+    {SOURCE_SEPARATOR, {0, 76, 250, 1}, 0, nullptr, nullptr, ALIGN_LEFT},
+    {SOURCE_TIME, {0, 77, 250, 29}, 102, &FreeMonoBold18pt7b, nullptr,
+     ALIGN_CENTER},
+    {SOURCE_DATE, {0, 106, 250, 16}, 120, &FreeSans9pt7b, nullptr,
+     ALIGN_CENTER},
+    {SOURCE_STATUS,
+     {248 - BATTERY_ICON_WIDTH - 4 - WIFI_ICON_WIDTH, 8,
+      BATTERY_ICON_WIDTH + 4 + WIFI_ICON_WIDTH, BATTERY_ICON_HEIGHT},
+     0, nullptr, nullptr, ALIGN_RIGHT},
+};
+#elif DISPLAY_WIDTH == 296 && DISPLAY_HEIGHT == 128
+// 2.9" (GxGDEH029A1 and compatibles)
+constexpr WidgetLayout MAIN_LAYOUT[] = {
+    {SOURCE_WEATHER_ICON, {4, 4, ICON_WIDTH, ICON_HEIGHT}, 0, nullptr,
+     nullptr, ALIGN_LEFT},
+    {SOURCE_TEMPERATURE, {52, 6, 110, 31}, 32, &FreeMonoBold18pt7b, nullptr,
+     ALIGN_LEFT},
+    {SOURCE_CONDITION, {52, 38, 110, 19}, 52, &FreeSans9pt7b, nullptr,
+     ALIGN_LEFT},
+    {SOURCE_MIN_MAX, {170, 18, 122, 19}, 32, &FreeSans9pt7b, nullptr,
+     ALIGN_LEFT},
+    {SOURCE_RAIN, {170, 38, 122, 19}, 52, &FreeSans9pt7b, nullptr,
+     ALIGN_LEFT},
+    {SOURCE_MESSAGE, {0, 59, 296, 21}, 74, &FreeSansBold9pt7b,
+     &FreeSans9pt7b, ALIGN_CENTER},
+    {SOURCE_SEPARATOR, {0, 82, 296, 1}, 0, nullptr, nullptr, ALIGN_LEFT},
+    {SOURCE_TIME, {0, 83, 296, 29}, 108, &FreeMonoBold18pt7b, nullptr,
+     ALIGN_CENTER},
+    {SOURCE_DATE, {0, 112, 296, 16}, 126, &FreeSans9pt7b, nullptr,
+     ALIGN_CENTER},
+    {SOURCE_STATUS,
+     {292 - BATTERY_ICON_WIDTH - 4 - WIFI_ICON_WIDTH, 8,
+      BATTERY_ICON_WIDTH + 4 + WIFI_ICON_WIDTH, BATTERY_ICON_HEIGHT},
+     0, nullptr, nullptr, ALIGN_RIGHT},
+};
+#else
+#error "No screen layout for this DISPLAY_WIDTH x DISPLAY_HEIGHT"
+#endif
+
+constexpr size_t MAIN_WIDGET_COUNT =
+    sizeof(MAIN_LAYOUT) / sizeof(MAIN_LAYOUT[0]);
+
+// Widget sets are bitmasks of MAIN_LAYOUT indices
+typedef uint16_t WidgetMask;
+#define ALL_WIDGETS ((WidgetMask)((1UL << MAIN_WIDGET_COUNT) - 1))
+
+constexpr bool widgetsFit(const WidgetLayout *w, size_t n) {
+  return n == 0 ||
+         (w->bounds.x >= 0 && w->bounds.y >= 0 &&
+          w->bounds.x + w->bounds.w <= DISPLAY_WIDTH &&
+          w->bounds.y + w->bounds.h <= DISPLAY_HEIGHT &&
+          widgetsFit(w + 1, n - 1));
+}
+
+static_assert(MAIN_WIDGET_COUNT <= 16, "WidgetMask holds 16 widgets");
+static_assert(widgetsFit(MAIN_LAYOUT, MAIN_WIDGET_COUNT),
+              "MAIN_LAYOUT has a widget outside the screen");
+
+// What the panel currently shows (RTC-compatible)
+struct LayoutState {
+  bool valid; // false: panel content unknown, next draw is a full refresh
+  uint32_t keys[WIDGET_SOURCE_COUNT];
+};
+
+// FNV-1a, for keys of text widgets
+inline uint32_t layoutKey(const char *s) {
+  uint32_t hash = 2166136261UL;
+  for (; *s; s++) {
+    hash = (hash ^ (uint8_t)*s) * 16777619UL;
+  }
+  return hash;
+}
+
+inline bool rectsOverlap(const WidgetRect &a, const WidgetRect &b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h &&
+         b.y < a.y + a.h;
+}
+
+// Smallest rectangle covering a and b (an empty a is ignored)
+inline WidgetRect unionRect(const WidgetRect &a, const WidgetRect &b) {
+  if (a.w <= 0 || a.h <= 0)
+    return b;
+  int16_t x0 = min(a.x, b.x);
+  int16_t y0 = min(a.y, b.y);
+  int16_t x1 = max((int16_t)(a.x + a.w), (int16_t)(b.x + b.w));
+  int16_t y1 = max((int16_t)(a.y + a.h), (int16_t)(b.y + b.h));
+  WidgetRect area = {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+  return area;
+}
+
+// Smallest rectangle covering every widget in mask
+inline WidgetRect widgetBounds(WidgetMask mask) {
+  WidgetRect area = {0, 0, 0, 0};
+  for (size_t i = 0; i < MAIN_WIDGET_COUNT; i++) {
+    if (mask & (1 << i))
+      area = unionRect(area, MAIN_LAYOUT[i].bounds);
+  }
+  return area;
+}
+
+// Widgets that reach into area grown by margin pixels on every side
+inline WidgetMask widgetsTouching(const WidgetRect &area, int16_t margin) {
+  WidgetRect grown = {(int16_t)(area.x - margin), (int16_t)(area.y - margin),
+                      (int16_t)(area.w + 2 * margin),
+                      (int16_t)(area.h + 2 * margin)};
+  WidgetMask mask = 0;
+  for (size_t i = 0; i < MAIN_WIDGET_COUNT; i++) {
+    if (rectsOverlap(MAIN_LAYOUT[i].bounds, grown))
+      mask |= 1 << i;
+  }
+  return mask;
+}
+
+#endif // LAYOUT_H
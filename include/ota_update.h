@@ -0,0 +1,360 @@
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+#include "config.h"
+#include "dns_cache.h"
+#include "energy_model.h"
+#include "tls_client.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+
+// Delta OTA. The remote response may offer a newer firmware as a binary
+// delta against the running image (built by tools/make_delta.py). The
+// delta is streamed from the update server and applied straight into the
+// inactive OTA slot through a small buffer, so RAM use stays bounded and
+// the radio is only up for the size of the delta.
+//
+// "firmware": {"version": 4, "url": "http://192.168.1.173:3000/fw/3-4.bin",
+//              "base_sha256": "<running image>", "sha256": "<new image>",
+//              "size": <new image bytes>}
+//
+// Delta format (little endian): "MDLT", u8 format, u8[3] reserved,
+// u32 new size, then ops until OTA_OP_END:
+//   OTA_OP_COPY   u32 offset, u32 length  - bytes from the running image
+//   OTA_OP_INSERT u32 length, data        - literal bytes
+//
+// After an update the new image is on probation for OTA_PROBATION_WAKES
+// wakes; a crash or watchdog reset in that time boots the previous slot
+// and the version is remembered as rejected, so it is not offered again
+// and again. Only a newer version is installed after that.
+//
+// That check runs in setup(), so an image that resets before getting
+// there needs the bootloader: with CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+// the new image stays pending until otaCheckProbation() has taken over,
+// and the bootloader boots the previous slot if it never does.
+
+#define OTA_DELTA_MAGIC 0x544C444D // "MDLT"
+#define OTA_DELTA_FORMAT 1
+#define OTA_OP_END 0
+#define OTA_OP_COPY 1
+#define OTA_OP_INSERT 2
+#define OTA_CHUNK_SIZE 1024
+#define OTA_URL_MAX 128
+
+#define OTA_NAMESPACE "ota"
+
+// Update offered by the server
+struct OtaOffer {
+  uint16_t version; // 0 = no offer
+  uint32_t size;
+  uint8_t sha256[32];
+  uint8_t baseSha256[32];
+  char url[OTA_URL_MAX];
+};
+
+inline bool parseHexDigest(const char *hex, uint8_t *out) {
+  if (!hex || strlen(hex) != 64)
+    return false;
+  for (int i = 0; i < 32; i++) {
+    char byte[3] = {hex[i * 2], hex[i * 2 + 1], '\0'};
+    char *end;
+    out[i] = strtoul(byte, &end, 16);
+    if (*end != '\0')
+      return false;
+  }
+  return true;
+}
+
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+// The Arduino core marks a pending image valid before setup() unless this
+// returns true; otaCheckProbation() does it instead (this header is only
+// included from main.cpp, so it is defined once)
+extern "C" bool verifyRollbackLater() { return true; }
+#endif
+
+// Newest version that failed probation here (0 = none)
+inline uint16_t otaRejectedVersion() {
+  Preferences prefs;
+  prefs.begin(OTA_NAMESPACE, true);
+  uint16_t rejected = prefs.getUShort("rejected", 0);
+  prefs.end();
+  return rejected;
+}
+
+// Read a "firmware" object from the remote response
+inline void parseOtaOffer(JsonObject json, OtaOffer *offer) {
+  offer->version = 0;
+  if (json.isNull() || !json["version"].is<int>())
+    return;
+
+  const char *url = json["url"];
+  if (!url || strlen(url) >= OTA_URL_MAX ||
+      !parseHexDigest(json["sha256"], offer->sha256) ||
+      !parseHexDigest(json["base_sha256"], offer->baseSha256)) {
+    Serial.println("OTA: malformed firmware offer");
+    return;
+  }
+  uint16_t version = json["version"];
+  if (version <= otaRejectedVersion()) {
+    Serial.printf("OTA: v%d was rolled back before, ignoring\n", version);
+    return;
+  }
+  strcpy(offer->url, url);
+  offer->size = json["size"] | 0;
+  offer->version = version;
+}
+
+// Read exactly len bytes from the HTTP stream
+inline bool otaReadFully(WiFiClient *stream, uint8_t *buf, size_t len) {
+  unsigned long last = millis();
+  while (len > 0) {
+    int n = stream->read(buf, len);
+    if (n > 0) {
+      buf += n;
+      len -= n;
+      last = millis();
+    } else if (!stream->connected() || millis() - last > 5000) {
+      return false;
+    } else {
+      delay(1);
+    }
+  }
+  return true;
+}
+
+inline bool otaReadU32(WiFiClient *stream, uint32_t *value) {
+  return otaReadFully(stream, (uint8_t *)value, 4);
+}
+
+// Write to the new slot and hash what was written
+inline bool otaWrite(esp_ota_handle_t handle, mbedtls_sha256_context *sha,
+                     const uint8_t *data, size_t len, uint32_t *written) {
+  mbedtls_sha256_update(sha, data, len);
+  *written += len;
+  return esp_ota_write(handle, data, len) == ESP_OK;
+}
+
+// Apply the ops of a delta stream into the update slot
+inline bool otaApplyOps(WiFiClient *stream, const esp_partition_t *running,
+                        esp_ota_handle_t handle, mbedtls_sha256_context *sha,
+                        uint32_t newSize) {
+  uint8_t chunk[OTA_CHUNK_SIZE] __attribute__((aligned(4)));
+  uint32_t written = 0;
+
+  while (true) {
+    uint8_t op;
+    uint32_t offset = 0, length;
+    if (!otaReadFully(stream, &op, 1))
+      return false;
+    if (op == OTA_OP_END)
+      break;
+    if ((op == OTA_OP_COPY && !otaReadU32(stream, &offset)) ||
+        (op != OTA_OP_COPY && op != OTA_OP_INSERT) ||
+        !otaReadU32(stream, &length) || written + length > newSize) {
+      Serial.println("OTA: corrupt delta");
+      return false;
+    }
+
+    while (length > 0) {
+      size_t n = min(length, (uint32_t)OTA_CHUNK_SIZE);
+      bool ok = op == OTA_OP_COPY
+                    ? esp_partition_read(running, offset, chunk, n) == ESP_OK
+                    : otaReadFully(stream, chunk, n);
+      if (!ok || !otaWrite(handle, sha, chunk, n, &written))
+        return false;
+      offset += n;
+      length -= n;
+    }
+  }
+  return written == newSize;
+}
+
+// Download and apply a delta update. Reboots into the new image on
+// success; returns false (running image untouched) otherwise.
+inline bool otaApplyDelta(const OtaOffer &offer, DnsCache &dns,
+                          TlsSessionCache &tls) {
+  if (offer.version <= otaRejectedVersion()) {
+    Serial.printf("OTA: v%d was rolled back before\n", offer.version);
+    return false;
+  }
+  const esp_partition_t *running = esp_ota_get_running_partition();
+  const esp_partition_t *target = esp_ota_get_next_update_partition(NULL);
+  if (!running || !target || offer.size > target->size) {
+    Serial.println("OTA: no suitable update partition");
+    return false;
+  }
+
+  // The delta only makes sense against the exact image it was built from
+  uint8_t runningSha[32];
+  if (esp_partition_get_sha256(running, runningSha) != ESP_OK ||
+      memcmp(runningSha, offer.baseSha256, 32) != 0) {
+    Serial.println("OTA: delta built for a different base image");
+    return false;
+  }
+
+  WiFiClient plainClient;
+  ResumableTlsClient tlsClient(offer.url, tls);
+  WiFiClient &client = isHttpsUrl(offer.url) ? tlsClient : plainClient;
+  HTTPClient http;
+
+  Serial.printf("OTA: fetching v%d delta from %s\n", offer.version,
+                offer.url);
+  setPowerPhase(PHASE_NETWORK);
+  bool connected = beginCached(http, client, offer.url, dns);
+  http.setTimeout(10000);
+  if (connected)
+    countHttpRequest();
+  int httpCode = connected ? http.GET() : HTTPC_ERROR_CONNECTION_REFUSED;
+  if (httpCode != HTTP_CODE_OK) {
+    Serial.printf("OTA: HTTP error %d\n", httpCode);
+    http.end();
+    setPowerPhase(PHASE_COMPUTE);
+    return false;
+  }
+
+  WiFiClient *stream = http.getStreamPtr();
+  uint32_t magic = 0, newSize = 0;
+  uint8_t header[4];
+  esp_ota_handle_t handle = 0;
+  bool ok = otaReadU32(stream, &magic) && otaReadFully(stream, header, 4) &&
+            otaReadU32(stream, &newSize) && magic == OTA_DELTA_MAGIC &&
+            header[0] == OTA_DELTA_FORMAT && newSize == offer.size &&
+            esp_ota_begin(target, newSize, &handle) == ESP_OK;
+
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+
+  unsigned long start = millis();
+  ok = ok && otaApplyOps(stream, running, handle, &sha, newSize);
+  http.end();
+  setPowerPhase(PHASE_COMPUTE);
+
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&sha, digest);
+  mbedtls_sha256_free(&sha);
+
+  if (ok && memcmp(digest, offer.sha256, 32) != 0) {
+    Serial.println("OTA: image hash mismatch");
+    ok = false;
+  }
+  // esp_ota_end() also checks the image header and checksum
+  if (handle && ok) {
+    ok = esp_ota_end(handle) == ESP_OK;
+  } else if (handle) {
+    esp_ota_abort(handle);
+  }
+  if (!ok) {
+    Serial.println("OTA: update failed, staying on current image");
+    return false;
+  }
+
+  // Remember where to go back to before switching: a reset between the
+  // two steps must never boot the new image without its probation
+  Preferences prefs;
+  prefs.begin(OTA_NAMESPACE, false);
+  prefs.putUInt("prev", running->address);
+  prefs.putUShort("version", offer.version);
+  prefs.putUChar("wakes", OTA_PROBATION_WAKES);
+  if (esp_ota_set_boot_partition(target) != ESP_OK) {
+    prefs.putUChar("wakes", 0);
+    prefs.end();
+    Serial.println("OTA: update failed, staying on current image");
+    return false;
+  }
+  prefs.end();
+
+  Serial.printf("OTA: v%d written in %lu ms, rebooting\n", offer.version,
+                millis() - start);
+  Serial.flush();
+  esp_restart();
+  return true; // Not reached
+}
+
+// Call first thing on every wake. probationWakes is an RTC copy of the
+// NVS counter, reloaded after any reset that was not a deep sleep wake.
+// While the running image is on probation, a crash/watchdog reset boots
+// the previous image again and records the new version as rejected.
+inline void otaCheckProbation(esp_reset_reason_t reason,
+                              uint8_t &probationWakes) {
+  if (reason == ESP_RST_DEEPSLEEP)
+    return; // RTC copy is current
+
+  Preferences prefs;
+  prefs.begin(OTA_NAMESPACE, true);
+  probationWakes = prefs.getUChar("wakes", 0);
+  uint32_t prev = prefs.getUInt("prev", 0);
+  uint16_t version = prefs.getUShort("version", 0);
+  prefs.end();
+
+  if (probationWakes == 0)
+    return;
+
+  // Running the previous image again: the bootloader rolled back
+  const esp_partition_t *running = esp_ota_get_running_partition();
+  bool rolledBack = running && running->address == prev;
+  // Brownouts are a flat battery, not the image's fault
+  bool failed = reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT ||
+                reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT;
+  if (!rolledBack && !failed) {
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+    // From here on a failed wake is caught by the check above
+    esp_ota_mark_app_valid_cancel_rollback();
+#endif
+    return;
+  }
+
+  probationWakes = 0;
+  prefs.begin(OTA_NAMESPACE, false);
+  prefs.putUChar("wakes", 0);
+  if (version > prefs.getUShort("rejected", 0)) {
+    prefs.putUShort("rejected", version);
+  }
+  prefs.end();
+
+  if (rolledBack) {
+    Serial.printf("OTA: v%d failed before its first wake, rolled back\n",
+                  version);
+    return;
+  }
+
+  const esp_partition_t *previous = NULL;
+  esp_partition_iterator_t it = esp_partition_find(
+      ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, NULL);
+  for (; it && !previous; it = esp_partition_next(it)) {
+    const esp_partition_t *p = esp_partition_get(it);
+    if (p->address == prev)
+      previous = p;
+  }
+  esp_partition_iterator_release(it);
+
+  if (previous && esp_ota_set_boot_partition(previous) == ESP_OK) {
+    Serial.printf("OTA: v%d failed (reset %d), rolling back\n", version,
+                  reason);
+    Serial.flush();
+    esp_restart();
+  }
+  Serial.println("OTA: rollback partition not found");
+}
+
+// Call at the end of a normal wake: one more probation wake survived
+inline void otaConfirmWake(uint8_t &probationWakes) {
+  if (probationWakes == 0)
+    return;
+
+  probationWakes--;
+  Preferences prefs;
+  prefs.begin(OTA_NAMESPACE, false);
+  prefs.putUChar("wakes", probationWakes);
+  prefs.end();
+  if (probationWakes == 0) {
+    Serial.println("OTA: new image confirmed");
+  }
+}
+
+#endif // OTA_UPDATE_H
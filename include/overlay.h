@@ -0,0 +1,107 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include "config.h"
+#include "layout.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Local overlays on remote frames. The remote response can reserve boxes
+// on its image for content the device draws itself:
+//
+// "overlays": [{"type": "clock", "x": 170, "y": 0, "w": 80, "h": 26,
+//               "font": "large", "align": "right"},
+//              {"type": "status", "x": 2, "y": 2, "w": 32, "h": 10}]
+//
+// Types: "clock", "date", "status" (WiFi + battery). Fonts: "small",
+// "bold", "large". Text sits 4 px above the bottom of its box. Between
+// content checks, timer wakes redraw only the overlays that changed over
+// the cached frame, without turning the radio on.
+
+#define REMOTE_MAX_OVERLAYS 4
+#define OVERLAY_BASELINE_INSET 4
+
+enum OverlayFont : uint8_t { OVERLAY_FONT_SMALL = 0, OVERLAY_FONT_BOLD,
+                             OVERLAY_FONT_LARGE };
+
+const GFXfont *const OVERLAY_FONTS[] = {&FreeSans9pt7b, &FreeSansBold9pt7b,
+                                        &FreeMonoBold18pt7b};
+
+struct RemoteOverlay {
+  uint8_t source; // WidgetSource
+  uint8_t font;   // OverlayFont
+  uint8_t align;  // TextAlignment
+  WidgetRect bounds;
+};
+
+// RTC-compatible overlay set for the current remote frame
+struct RemoteOverlays {
+  uint8_t count;
+  bool drawn;         // Panel shows the remote frame with these overlays
+  uint32_t nextFetch; // Local deadline for the next content check
+  RemoteOverlay items[REMOTE_MAX_OVERLAYS];
+  uint32_t keys[REMOTE_MAX_OVERLAYS]; // Widget keys last drawn
+};
+
+// Layout entry for drawing an overlay with the main screen widgets
+inline WidgetLayout overlayWidget(const RemoteOverlay &overlay) {
+  WidgetLayout widget = {(WidgetSource)overlay.source,
+                         overlay.bounds,
+                         (int16_t)(overlay.bounds.y + overlay.bounds.h -
+                                   OVERLAY_BASELINE_INSET),
+                         OVERLAY_FONTS[overlay.font],
+                         nullptr,
+                         (TextAlignment)overlay.align};
+  return widget;
+}
+
+// Read "overlays" from a remote response; bad entries are skipped
+inline void parseOverlays(JsonArray json, RemoteOverlays *overlays) {
+  overlays->count = 0;
+  overlays->drawn = false;
+  if (json.isNull())
+    return;
+
+  for (JsonObject item : json) {
+    if (overlays->count >= REMOTE_MAX_OVERLAYS)
+      break;
+
+    RemoteOverlay overlay;
+    const char *type = item["type"] | "";
+    if (strcmp(type, "clock") == 0) {
+      overlay.source = SOURCE_TIME;
+    } else if (strcmp(type, "date") == 0) {
+      overlay.source = SOURCE_DATE;
+    } else if (strcmp(type, "status") == 0) {
+      overlay.source = SOURCE_STATUS;
+    } else {
+      Serial.printf("Overlay: unknown type '%s'\n", type);
+      continue;
+    }
+
+    const char *font = item["font"] | "small";
+    overlay.font = strcmp(font, "large") == 0  ? OVERLAY_FONT_LARGE
+                   : strcmp(font, "bold") == 0 ? OVERLAY_FONT_BOLD
+                                               : OVERLAY_FONT_SMALL;
+    const char *align = item["align"] | "left";
+    overlay.align = strcmp(align, "center") == 0  ? ALIGN_CENTER
+                    : strcmp(align, "right") == 0 ? ALIGN_RIGHT
+                                                  : ALIGN_LEFT;
+
+    WidgetRect &b = overlay.bounds;
+    b.x = item["x"] | -1;
+    b.y = item["y"] | -1;
+    b.w = item["w"] | 0;
+    b.h = item["h"] | 0;
+    if (b.x < 0 || b.y < 0 || b.w <= 0 || b.h <= 0 ||
+        b.x + b.w > DISPLAY_WIDTH || b.y + b.h > DISPLAY_HEIGHT) {
+      Serial.printf("Overlay: '%s' box outside the screen\n", type);
+      continue;
+    }
+
+    overlays->items[overlays->count++] = overlay;
+  }
+  Serial.printf("Overlays: %d\n", overlays->count);
+}
+
+#endif // OVERLAY_H
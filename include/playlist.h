@@ -0,0 +1,88 @@
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include "config.h"
+#include "sd_storage.h"
+#include <Arduino.h>
+#include <time.h>
+
+// Offline remote-mode playlist.
+// The server can send a batch of frames in one response; they are stored
+// compressed on the SD card and shown one per timer wake without turning
+// the radio on. The schedule lives in RTC memory. When the first frame
+// has a future display_at, the playlist starts out waiting for it.
+
+#define PLAYLIST_MAX_FRAMES 16
+
+struct PlaylistEntry {
+  uint32_t displayAt; // Unix time to show this frame (0 = after previous)
+  uint16_t duration;  // Seconds to show this frame
+  uint16_t reserved;
+};
+
+// RTC-compatible playlist state
+struct Playlist {
+  uint8_t count;   // Frames stored on SD (0 = no playlist)
+  uint8_t current; // Frame currently on screen
+  bool waiting;    // Frame current is not on screen yet (display_at)
+  PlaylistEntry entries[PLAYLIST_MAX_FRAMES];
+};
+
+inline void clearPlaylist(Playlist &playlist) {
+  playlist.count = 0;
+  playlist.current = 0;
+  playlist.waiting = false;
+}
+
+// True while there are frames left to show without going online
+inline bool playlistHasNext(const Playlist &playlist) {
+  return playlist.count > 0 &&
+         (playlist.waiting || playlist.current + 1 < playlist.count);
+}
+
+// Load the next frame from SD into buffer. On failure the playlist is
+// dropped so the caller falls back to the network.
+inline bool playlistAdvance(Playlist &playlist, uint8_t *buffer,
+                            size_t maxSize, size_t *size, uint8_t *flags) {
+  if (!playlistHasNext(playlist))
+    return false;
+
+  if (playlist.waiting) {
+    playlist.waiting = false;
+  } else {
+    playlist.current++;
+  }
+  if (!sdLoadFrame(playlist.current, buffer, maxSize, size, flags)) {
+    Serial.printf("Playlist: frame %d missing, going online\n",
+                  playlist.current);
+    clearPlaylist(playlist);
+    return false;
+  }
+
+  Serial.printf("Playlist: showing frame %d/%d (offline)\n",
+                playlist.current + 1, playlist.count);
+  return true;
+}
+
+// Seconds to sleep before the next frame is due
+inline int playlistSleepSeconds(const Playlist &playlist, int fallbackSec) {
+  if (playlist.count == 0)
+    return fallbackSec;
+
+  const PlaylistEntry &entry = playlist.entries[playlist.current];
+
+  // Next frame has an absolute time and the clock is set
+  time_t now = time(nullptr);
+  int next = playlist.waiting ? playlist.current : playlist.current + 1;
+  if (next < playlist.count && now > 1000000000) {
+    uint32_t nextAt = playlist.entries[next].displayAt;
+    if (nextAt > 0) {
+      long wait = (long)nextAt - (long)now;
+      return wait > 1 ? wait : 1;
+    }
+  }
+
+  return entry.duration > 0 ? entry.duration : fallbackSec;
+}
+
+#endif // PLAYLIST_H
@@ -0,0 +1,128 @@
+#ifndef POWER_PROFILE_H
+#define POWER_PROFILE_H
+
+#include "config.h"
+#include <Arduino.h>
+
+// CPU frequency per phase of the wake. Waiting on the radio or the panel
+// BUSY pin runs slow, parse/decode/render bursts run at full speed.
+// Time spent in each phase is accounted so the wake can report an energy
+// estimate per profile (from the POWER_MA_* current model in config.h).
+
+enum PowerPhase : uint8_t {
+  PHASE_COMPUTE = 0,  // Parse, decode, render
+  PHASE_NETWORK,      // Waiting on WiFi association or HTTP
+  PHASE_DISPLAY_WAIT, // Waiting on the panel BUSY pin
+  PHASE_COUNT
+};
+
+static const char *const powerPhaseNames[PHASE_COUNT] = {"compute", "network",
+                                                         "display"};
+
+// Accumulated per-phase totals, kept in RTC memory across wakes
+struct PowerProfileStats {
+  uint32_t wakes;
+  uint32_t ms[PHASE_COUNT];
+  uint32_t uAh[PHASE_COUNT];
+};
+
+static PowerPhase currentPhase = PHASE_COMPUTE;
+static uint32_t phaseStart = 0;
+static bool radioOn = false;
+static uint32_t phaseMs[PHASE_COUNT] = {0};
+static uint32_t phaseRadioMs[PHASE_COUNT] = {0};
+static uint32_t phaseMhz[PHASE_COUNT] = {0};
+
+inline uint32_t phaseTargetMhz(PowerPhase phase) {
+  uint32_t mhz;
+  switch (phase) {
+  case PHASE_NETWORK:
+    mhz = CPU_MHZ_NETWORK;
+    break;
+  case PHASE_DISPLAY_WAIT:
+    mhz = CPU_MHZ_DISPLAY_WAIT;
+    break;
+  default:
+    mhz = CPU_MHZ_COMPUTE;
+    break;
+  }
+  // The WiFi driver needs at least 80 MHz
+  return (radioOn && mhz < 80) ? 80 : mhz;
+}
+
+// Charge time to the phase that is ending
+inline void accountPhase() {
+  uint32_t now = millis();
+  uint32_t elapsed = now - phaseStart;
+  phaseMs[currentPhase] += elapsed;
+  if (radioOn) {
+    phaseRadioMs[currentPhase] += elapsed;
+  }
+  phaseStart = now;
+}
+
+// Switch phase; returns the previous one so callers can restore it
+inline PowerPhase setPowerPhase(PowerPhase phase) {
+  PowerPhase previous = currentPhase;
+  accountPhase();
+  currentPhase = phase;
+
+#if POWER_PROFILES_ENABLED
+  uint32_t mhz = phaseTargetMhz(phase);
+  if (getCpuFrequencyMhz() != mhz) {
+    setCpuFrequencyMhz(mhz);
+  }
+#endif
+  phaseMhz[phase] = getCpuFrequencyMhz();
+  return previous;
+}
+
+// Radio on/off changes the current model and the minimum frequency
+inline void setRadioPower(bool on) {
+  accountPhase();
+  radioOn = on;
+  setPowerPhase(currentPhase);
+}
+
+// Estimated charge for one phase of this wake in uAh
+inline uint32_t phaseEnergyUAh(int phase) {
+  float cpuMa = POWER_MA_CPU_BASE + POWER_MA_PER_MHZ * phaseMhz[phase];
+  float mAms = cpuMa * phaseMs[phase] + POWER_MA_RADIO * phaseRadioMs[phase];
+  return mAms / 3600.0;
+}
+
+// Time the radio was up during this wake
+inline uint32_t radioOnMs() {
+  accountPhase();
+  uint32_t total = 0;
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    total += phaseRadioMs[i];
+  }
+  return total;
+}
+
+// Print this wake's per-phase time and energy, and add it to the totals.
+// Returns the estimated energy of the whole wake in uAh.
+inline uint32_t reportPowerProfile(PowerProfileStats &stats) {
+  accountPhase();
+  stats.wakes++;
+
+  uint32_t total = 0;
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    uint32_t uAh = phaseEnergyUAh(i);
+    stats.ms[i] += phaseMs[i];
+    stats.uAh[i] += uAh;
+    total += uAh;
+    Serial.printf("Power: %-7s %3lu MHz %6lu ms (radio %lu ms) %4lu uAh | "
+                  "avg %lu ms %lu uAh\n",
+                  powerPhaseNames[i], (unsigned long)phaseMhz[i],
+                  (unsigned long)phaseMs[i], (unsigned long)phaseRadioMs[i],
+                  (unsigned long)uAh,
+                  (unsigned long)(stats.ms[i] / stats.wakes),
+                  (unsigned long)(stats.uAh[i] / stats.wakes));
+  }
+  Serial.printf("Power: wake total %lu uAh\n", (unsigned long)total);
+  return total;
+}
+
+#endif // POWER_PROFILE_H
@@ -0,0 +1,130 @@
+#ifndef REFRESH_SCHEDULER_H
+#define REFRESH_SCHEDULER_H
+
+#include "config.h"
+#include <Arduino.h>
+#include <time.h>
+
+// Ghosting-aware refresh planning. Every partial refresh is counted in the
+// grid regions it touches (RTC memory). When an update touches a region
+// that is due for cleaning, the update is done as a clean refresh instead;
+// when most of the screen is due, or once a night in the quiet window, it
+// becomes a full refresh.
+
+#define GHOST_REGIONS (GHOST_REGION_COLS * GHOST_REGION_ROWS)
+#define GHOST_REGION_W                                                         \
+  ((DISPLAY_WIDTH + GHOST_REGION_COLS - 1) / GHOST_REGION_COLS)
+#define GHOST_REGION_H                                                         \
+  ((DISPLAY_HEIGHT + GHOST_REGION_ROWS - 1) / GHOST_REGION_ROWS)
+#define QUIET_FULL_GAP_SEC (12 * 3600UL) // At most one quiet full per night
+
+enum RefreshKind : uint8_t {
+  REFRESH_PARTIAL = 0, // Plain partial refresh of the area
+  REFRESH_CLEAN,       // Area inverted, then redrawn (clears ghosting)
+  REFRESH_FULL         // Whole screen, full waveform
+};
+
+const char *const REFRESH_KIND_NAMES[] = {"partial", "clean", "full"};
+
+struct GhostRegion {
+  uint16_t partials;   // Partial refreshes since the region was clean
+  uint32_t dirtySince; // time(nullptr) of the first of them (0 = unknown)
+};
+
+// RTC-compatible scheduler state
+struct RefreshScheduler {
+  uint16_t maxPartials; // From RuntimeConfig, set every wake
+  uint32_t lastFull;    // time(nullptr) of the last full refresh
+  GhostRegion regions[GHOST_REGIONS];
+};
+
+static_assert(GHOST_REGIONS <= 32, "region masks are 32 bits");
+
+inline bool clockIsSet(time_t now) { return now > 1000000000; }
+
+inline bool inQuietWindow(time_t now) {
+  struct tm t;
+  localtime_r(&now, &t);
+  if (QUIET_START_HOUR <= QUIET_END_HOUR)
+    return t.tm_hour >= QUIET_START_HOUR && t.tm_hour < QUIET_END_HOUR;
+  return t.tm_hour >= QUIET_START_HOUR || t.tm_hour < QUIET_END_HOUR;
+}
+
+// Grid regions overlapped by a logical rectangle
+inline uint32_t ghostRegionMask(int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (w <= 0 || h <= 0)
+    return 0;
+  int c0 = constrain(x / GHOST_REGION_W, 0, GHOST_REGION_COLS - 1);
+  int c1 = constrain((x + w - 1) / GHOST_REGION_W, 0, GHOST_REGION_COLS - 1);
+  int r0 = constrain(y / GHOST_REGION_H, 0, GHOST_REGION_ROWS - 1);
+  int r1 = constrain((y + h - 1) / GHOST_REGION_H, 0, GHOST_REGION_ROWS - 1);
+  uint32_t mask = 0;
+  for (int r = r0; r <= r1; r++) {
+    for (int c = c0; c <= c1; c++) {
+      mask |= 1UL << (r * GHOST_REGION_COLS + c);
+    }
+  }
+  return mask;
+}
+
+inline bool ghostRegionDue(const GhostRegion &region, uint16_t maxPartials,
+                           time_t now) {
+  if (region.partials == 0)
+    return false;
+  return region.partials >= maxPartials ||
+         (clockIsSet(now) && region.dirtySince != 0 &&
+          (uint32_t)now - region.dirtySince >= GHOST_MAX_AGE_MIN * 60UL);
+}
+
+// How to show a changed area
+inline RefreshKind planRefresh(const RefreshScheduler &sched, int16_t x,
+                               int16_t y, int16_t w, int16_t h) {
+  time_t now = time(nullptr);
+  uint32_t touched = ghostRegionMask(x, y, w, h);
+  int due = 0;
+  bool dirty = false, touchesDue = false;
+  for (int i = 0; i < GHOST_REGIONS; i++) {
+    dirty |= sched.regions[i].partials > 0;
+    if (ghostRegionDue(sched.regions[i], sched.maxPartials, now)) {
+      due++;
+      touchesDue |= (touched >> i) & 1;
+    }
+  }
+
+  // Nobody is looking: clean the whole screen once a night
+  if (dirty && clockIsSet(now) && inQuietWindow(now) &&
+      (uint32_t)now - sched.lastFull >= QUIET_FULL_GAP_SEC)
+    return REFRESH_FULL;
+
+  // Cleaning most of the screen piece by piece costs more than one full
+  if (due > GHOST_REGIONS / 2)
+    return REFRESH_FULL;
+  return touchesDue ? REFRESH_CLEAN : REFRESH_PARTIAL;
+}
+
+// Account for a refresh that was done
+inline void recordRefresh(RefreshScheduler &sched, RefreshKind kind,
+                          int16_t x, int16_t y, int16_t w, int16_t h) {
+  uint32_t now = time(nullptr);
+  uint32_t touched =
+      kind == REFRESH_FULL ? 0xFFFFFFFFUL : ghostRegionMask(x, y, w, h);
+  if (kind == REFRESH_FULL)
+    sched.lastFull = now;
+
+  for (int i = 0; i < GHOST_REGIONS; i++) {
+    if (!((touched >> i) & 1))
+      continue;
+    GhostRegion &region = sched.regions[i];
+    if (kind == REFRESH_PARTIAL) {
+      if (region.partials == 0)
+        region.dirtySince = clockIsSet(now) ? now : 0;
+      if (region.partials < 0xFFFF)
+        region.partials++;
+    } else {
+      region.partials = 0;
+      region.dirtySince = 0;
+    }
+  }
+}
+
+#endif // REFRESH_SCHEDULER_H
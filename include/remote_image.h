@@ -0,0 +1,48 @@
+#ifndef REMOTE_IMAGE_H
+#define REMOTE_IMAGE_H
+
+#include "config.h"
+#include "frame_buffer.h"
+#include "json_stream.h"
+#include <Arduino.h>
+
+// Remote images: size, flags and the streamed base64 decode. Kept apart
+// from the fetch code (remote_mode.h) so the host benchmarks can run it.
+
+// Remote image size for the DISPLAY_WIDTH x DISPLAY_HEIGHT screen
+// Row-major layout, each row padded to whole bytes (32 x 122 = 3904 bytes)
+#define BITMAP_ROW_BYTES ((DISPLAY_WIDTH + 7) / 8)
+#define BITMAP_SIZE (BITMAP_ROW_BYTES * DISPLAY_HEIGHT)
+// Buffer must hold either layout (panel layout is 4000 bytes)
+#define REMOTE_BUFFER_SIZE                                                     \
+  (PANEL_BUFFER_SIZE > BITMAP_SIZE ? PANEL_BUFFER_SIZE : BITMAP_SIZE)
+
+// Remote image flags, declared by the server and stored with the image
+// "layout": "panel" -> image is in panel RAM layout (plain memcpy)
+// "black_bit": 1    -> 1 bits are black (panel uses 1 for white)
+#define REMOTE_IMAGE_PANEL_LAYOUT 0x01
+#define REMOTE_IMAGE_BLACK_IS_ONE 0x02
+
+// Pad a short image with white so the blit reads valid data
+inline void padRemoteImage(uint8_t *imageBuffer, size_t imageSize,
+                           uint8_t flags) {
+  uint8_t white = (flags & REMOTE_IMAGE_BLACK_IS_ONE) ? 0x00 : 0xFF;
+  memset(imageBuffer + imageSize, white, REMOTE_BUFFER_SIZE - imageSize);
+}
+
+// Decode a base64 image value from the stream into imageBuffer
+// (REMOTE_BUFFER_SIZE bytes)
+inline bool readRemoteImage(JsonStreamReader &reader, uint8_t flags,
+                            uint8_t *imageBuffer, size_t *imageSize) {
+  if (!reader.readBase64(imageBuffer, REMOTE_BUFFER_SIZE, imageSize)) {
+    Serial.printf("Remote image invalid or larger than %d bytes\n",
+                  REMOTE_BUFFER_SIZE);
+    return false;
+  }
+  padRemoteImage(imageBuffer, *imageSize, flags);
+  Serial.printf("Remote image decoded: %d bytes (%s)\n", (int)*imageSize,
+                (flags & REMOTE_IMAGE_PANEL_LAYOUT) ? "panel" : "rows");
+  return true;
+}
+
+#endif // REMOTE_IMAGE_H
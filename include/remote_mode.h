@@ -3,124 +3,341 @@
 
 #include "config.h"
 #include "display_manager.h"
+#include "dns_cache.h"
+#include "energy_model.h"
+#include "json_arena.h"
+#include "json_stream.h"
+#include "ota_update.h"
+#include "overlay.h"
+#include "playlist.h"
+#include "power_profile.h"
+#include "remote_image.h"
+#include "runtime_config.h"
+#include "sd_storage.h"
+#include "time_manager.h"
+#include "tls_client.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 #include <WiFi.h>
-#include <mbedtls/base64.h>
-
-// Display dimensions (GxDEPG0213BN is 250x122)
-#define DISPLAY_WIDTH 250
-#define DISPLAY_HEIGHT 122
-#define BITMAP_SIZE ((DISPLAY_WIDTH * DISPLAY_HEIGHT + 7) / 8) // ~3813 bytes
 
 // Remote mode response structure
 struct RemoteModeResponse {
   bool isRemote;
   bool success;
   int refreshSeconds;
+  long validForSec;  // Content unchanged for this long (-1 = no hint)
+  long nextCheckSec; // Don't check again before this (-1 = no hint)
+  uint32_t serverTime; // "server_time" or HTTP Date header (0 = unknown)
 };
 
+// Convert an absolute server timestamp hint into seconds from now.
+// Uses "server_time" from the response, or the local clock if it is set.
+inline long parseTimeHint(JsonVariant hint, uint32_t serverNow) {
+  if (!hint.is<uint32_t>() || serverNow == 0)
+    return -1;
+  uint32_t at = hint;
+  return at > serverNow ? (long)(at - serverNow) : 0;
+}
+
+// Response parsing. The body is streamed (json_stream.h): images are
+// decoded as they arrive, frames go to the SD card one by one, and only
+// the small fields are collected and parsed with ArduinoJson in an arena.
+// "layout" and "black_bit" must come before "image"/"frames".
+#define REMOTE_STR(x) #x
+#define REMOTE_XSTR(x) REMOTE_STR(x) // Macro value as a string literal
+#define REMOTE_KEY_MAX 24
+#define REMOTE_META_MAX 1536     // Small top-level fields, as JSON text
+#define REMOTE_FRAME_META_MAX 96 // Fields of one frame besides "image"
+#define REMOTE_ARENA_SIZE 2048
+
+static char remoteMeta[REMOTE_META_MAX];
+static uint8_t remoteArenaBuffer[REMOTE_ARENA_SIZE] __attribute__((aligned(8)));
+// A frame is decoded here first, so the one on screen stays intact
+static uint8_t remoteDecodeBuffer[REMOTE_BUFFER_SIZE]
+    __attribute__((aligned(4)));
+
+// Append "key": value to a JSON object being built in text
+inline bool copyMember(JsonStreamReader &reader, const char *key, char *out,
+                       size_t size, size_t *used) {
+  int n = snprintf(out + *used, size - *used, "%s\"%s\":",
+                   *used > 1 ? "," : "", key);
+  if (n < 0 || *used + n >= size)
+    return false;
+  *used += n;
+  return reader.copyValue(out, size, used);
+}
+
+inline void closeObject(char *out, size_t size, size_t used) {
+  if (used + 1 < size) {
+    out[used] = '}';
+    out[used + 1] = '\0';
+  }
+}
+
+// State of a "frames" batch while it streams in
+struct PlaylistIntake {
+  uint8_t flags;
+  uint32_t now;     // For display_at (0 = unknown)
+  int count;        // Frames kept
+  int decoded;      // Frame in remoteDecodeBuffer
+  bool stored;      // All kept frames are on the SD card
+  bool firstWaits;  // Frame 0 has a future display_at
+  size_t firstSize; // Decoded size of frame 0
+};
+
+// Read one frame object: image to SD, schedule into the playlist
+inline bool readPlaylistFrame(JsonStreamReader &reader, PlaylistIntake &in,
+                              JsonArena &arena, Playlist *playlist) {
+  char key[REMOTE_KEY_MAX];
+  char meta[REMOTE_FRAME_META_MAX] = "{";
+  size_t metaUsed = 1;
+  size_t size = 0;
+  bool imageOk = false;
+
+  if (reader.enter('{', '}')) {
+    do {
+      if (!reader.readKey(key, sizeof(key)))
+        return false;
+      if (strcmp(key, "image") == 0) {
+        imageOk = readRemoteImage(reader, in.flags, remoteDecodeBuffer, &size);
+      } else if (!copyMember(reader, key, meta, sizeof(meta), &metaUsed)) {
+        return false;
+      }
+    } while (reader.next('}'));
+  }
+  if (!reader.ok() || !imageOk)
+    return false;
+
+  closeObject(meta, sizeof(meta), metaUsed);
+  arena.reset();
+  JsonDocument doc(&arena);
+  if (deserializeJson(doc, meta))
+    return false;
+
+  int i = in.count++;
+  PlaylistEntry &entry = playlist->entries[i];
+  entry.displayAt = doc["display_at"] | 0;
+  entry.duration = doc["duration"] | 0; // 0: the response's refresh time
+  in.decoded = i;
+
+  if (in.stored && !sdSaveFrame(i, remoteDecodeBuffer, size, in.flags)) {
+    Serial.println("Playlist: SD unavailable, showing first frame only");
+    in.stored = false;
+  }
+  if (i == 0) {
+    in.firstWaits = in.now != 0 && entry.displayAt > in.now;
+    in.firstSize = size;
+  }
+  return true;
+}
+
+// Stream a "frames" array into the playlist (SD slots and schedule)
+inline bool readPlaylist(JsonStreamReader &reader, PlaylistIntake &in,
+                         JsonArena &arena, Playlist *playlist) {
+  clearPlaylist(*playlist); // Its SD slots are about to be overwritten
+  if (!reader.enter('[', ']'))
+    return reader.ok();
+  do {
+    bool keep = in.count < PLAYLIST_MAX_FRAMES && (in.count == 0 || in.stored);
+    if (!keep) {
+      if (!reader.copyValue())
+        return false; // Skipped without decoding
+    } else if (!readPlaylistFrame(reader, in, arena, playlist)) {
+      return false;
+    }
+  } while (reader.next(']'));
+
+  if (in.count == PLAYLIST_MAX_FRAMES || (in.count > 0 && !in.stored)) {
+    Serial.printf("Playlist: kept %d frames\n", in.count);
+  }
+  return reader.ok();
+}
+
 // Check remote mode status from API
 // Returns response with mode info
 inline RemoteModeResponse checkRemoteMode(uint8_t *imageBuffer,
-                                          size_t *imageSize) {
-  RemoteModeResponse response = {false, false, REMOTE_REFRESH_SEC};
+                                          size_t *imageSize,
+                                          uint8_t *imageFlags,
+                                          Playlist *playlist,
+                                          RemoteOverlays *overlays,
+                                          OtaOffer *otaOffer,
+                                          RuntimeConfig &config,
+                                          DnsCache &dns,
+                                          TlsSessionCache &tls) {
+  RemoteModeResponse response = {false, false, config.remoteRefreshSec, -1,
+                                 -1, 0};
 
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("WiFi not connected, skipping remote check");
     return response;
   }
 
+  WiFiClient plainClient;
+  ResumableTlsClient tlsClient(REMOTE_API_URL, tls);
+  WiFiClient &client = isHttpsUrl(REMOTE_API_URL) ? tlsClient : plainClient;
   HTTPClient http;
   Serial.println("Checking remote mode...");
-  http.begin(REMOTE_API_URL);
+  setPowerPhase(PHASE_NETWORK);
+  bool connected = beginCached(http, client, REMOTE_API_URL, dns);
   http.setTimeout(10000); // 10 second timeout
+  http.useHTTP10(true); // No chunked encoding, so the body can be streamed
+  http.addHeader("X-Firmware-Version", REMOTE_XSTR(FIRMWARE_VERSION));
 
-  int httpCode = http.GET();
+  // Server time comes for free with the response
+  const char *headerKeys[] = {"Date"};
+  http.collectHeaders(headerKeys, 1);
 
-  if (httpCode == HTTP_CODE_OK) {
-    String payload = http.getString();
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, payload);
+  if (connected)
+    countHttpRequest();
+  int httpCode = connected ? http.GET() : HTTPC_ERROR_CONNECTION_REFUSED;
+  char date[40];
+  response.serverTime =
+      parseHttpDate(copyHttpHeader(http, "Date", date, sizeof(date)));
 
-    if (!error) {
-      const char *mode = doc["mode"];
-      response.success = true;
+  if (httpCode != HTTP_CODE_OK) {
+    Serial.printf("HTTP error: %d\n", httpCode);
+    http.end();
+    setPowerPhase(PHASE_COMPUTE);
+    return response;
+  }
 
-      if (mode && strcmp(mode, "remote") == 0) {
-        response.isRemote = true;
+  // Walk the body: small fields into remoteMeta, images decoded on the fly
+  static JsonArena arena(remoteArenaBuffer, sizeof(remoteArenaBuffer));
+  JsonStreamReader reader(http.getStream());
+  PlaylistIntake intake = {0, 0, 0, -1, true, false, 0};
+  intake.now = time(nullptr) > 1000000000 ? time(nullptr)
+                                          : response.serverTime;
+  char key[REMOTE_KEY_MAX];
+  char value[16];
+  size_t metaUsed = 1, valueUsed;
+  bool imagesSeen = false, framesSeen = false, singleSeen = false;
+  bool imageOk = true, parsed = true;
+  size_t singleSize = 0;
+  strcpy(remoteMeta, "{");
 
-        // Get refresh rate if provided
-        if (doc["refresh_seconds"].is<int>()) {
-          response.refreshSeconds = doc["refresh_seconds"];
+  if (reader.enter('{', '}')) {
+    do {
+      if (!reader.readKey(key, sizeof(key))) {
+        parsed = false;
+      } else if (strcmp(key, "layout") == 0 || strcmp(key, "black_bit") == 0) {
+        // Needed to decode, so read here (and before any image)
+        valueUsed = 0;
+        value[0] = '\0';
+        if (imagesSeen) {
+          Serial.println("Remote: layout/black_bit after the image data");
         }
-
-        // Decode base64 image if present
-        if (doc["image"].is<const char*>()) {
-          const char *base64Image = doc["image"];
-          if (base64Image && strlen(base64Image) > 0) {
-            // Decode base64 to binary using mbedtls
-            size_t base64Len = strlen(base64Image);
-            size_t decodedLen = 0;
-
-            // First call to get required size
-            mbedtls_base64_decode(NULL, 0, &decodedLen,
-                                  (const unsigned char *)base64Image, base64Len);
-
-            if (decodedLen <= BITMAP_SIZE + 100) { // Allow some margin
-              int ret = mbedtls_base64_decode(
-                  imageBuffer, BITMAP_SIZE + 100, imageSize,
-                  (const unsigned char *)base64Image, base64Len);
-
-              if (ret == 0) {
-                Serial.printf("Remote image decoded: %d bytes\n", *imageSize);
-              } else {
-                Serial.printf("Base64 decode failed: %d\n", ret);
-                response.isRemote = false;
-              }
-            } else {
-              Serial.printf("Image too large: %d bytes (max %d)\n", decodedLen,
-                            BITMAP_SIZE);
-              response.isRemote = false;
-            }
-          }
+        parsed = !imagesSeen &&
+                 reader.copyValue(value, sizeof(value), &valueUsed);
+        if (strcmp(key, "layout") == 0 && strcmp(value, "\"panel\"") == 0) {
+          intake.flags |= REMOTE_IMAGE_PANEL_LAYOUT;
+        } else if (strcmp(key, "black_bit") == 0 && strcmp(value, "1") == 0) {
+          intake.flags |= REMOTE_IMAGE_BLACK_IS_ONE;
         }
-
-        Serial.printf("Remote mode active, refresh: %ds\n",
-                      response.refreshSeconds);
+      } else if (strcmp(key, "image") == 0) {
+        imagesSeen = singleSeen = true;
+        imageOk = readRemoteImage(reader, intake.flags, remoteDecodeBuffer,
+                                  &singleSize);
+      } else if (strcmp(key, "frames") == 0) {
+        imagesSeen = framesSeen = true;
+        parsed = readPlaylist(reader, intake, arena, playlist);
       } else {
-        Serial.println("Normal mode");
+        parsed = copyMember(reader, key, remoteMeta, sizeof(remoteMeta),
+                            &metaUsed);
       }
-    } else {
-      Serial.println("JSON parsing failed");
-    }
-  } else {
-    Serial.printf("HTTP error: %d\n", httpCode);
+    } while (parsed && reader.next('}'));
   }
-
+  parsed = parsed && reader.ok();
+  closeObject(remoteMeta, sizeof(remoteMeta), metaUsed);
   http.end();
-  return response;
-}
+  setPowerPhase(PHASE_COMPUTE);
+
+  arena.reset();
+  JsonDocument doc(&arena);
+  if (!parsed || deserializeJson(doc, remoteMeta)) {
+    Serial.println("JSON parsing failed");
+    clearPlaylist(*playlist); // Frames may be half written
+    return response;
+  }
+
+  const char *mode = doc["mode"];
+  response.success = true;
+
+  // Prefer an explicit JSON timestamp over the Date header
+  if (doc["server_time"].is<uint32_t>()) {
+    response.serverTime = doc["server_time"];
+  }
+
+  // Scheduling hints (apply in both modes)
+  uint32_t serverNow = response.serverTime;
+  if (serverNow == 0 && time(nullptr) > 1000000000) {
+    serverNow = time(nullptr);
+  }
+  response.validForSec = parseTimeHint(doc["valid_until"], serverNow);
+  response.nextCheckSec = parseTimeHint(doc["next_check"], serverNow);
+
+  // Firmware update offer (applied by the caller)
+  parseOtaOffer(doc["firmware"], otaOffer);
 
-// Draw remote image on display
-inline void drawRemoteImage(DisplayManager &display, uint8_t *imageBuffer,
-                            size_t imageSize) {
-  if (imageSize == 0) {
-    Serial.println("No remote image to draw");
-    return;
+  // Server-side tuning (versioned, applies in both modes)
+  if (applyRuntimeConfig(doc["config"], config) &&
+      !doc["refresh_seconds"].is<int>()) {
+    response.refreshSeconds = config.remoteRefreshSec;
+  }
+
+  if (!mode || strcmp(mode, "remote") != 0) {
+    clearPlaylist(*playlist);
+    Serial.println("Normal mode");
+    return response;
   }
 
-  // Invert all bits (fix color inversion: 1=black for e-ink)
-  for (size_t i = 0; i < imageSize; i++) {
-    imageBuffer[i] = ~imageBuffer[i];
+  response.isRemote = true;
+  parseOverlays(doc["overlays"], overlays);
+
+  // Get refresh rate if provided
+  if (doc["refresh_seconds"].is<int>()) {
+    response.refreshSeconds = doc["refresh_seconds"];
   }
 
-  display.clear();
-  display.drawBitmap(0, 0, imageBuffer, DISPLAY_WIDTH, DISPLAY_HEIGHT);
-  display.update();
+  if (framesSeen && intake.count > 0) {
+    // Batch of timed frames to cycle through offline. A first frame with
+    // a future display_at waits for it on the card; the screen keeps
+    // what it shows until then.
+    bool waits = intake.stored && intake.firstWaits;
+    if (intake.stored && (intake.count > 1 || waits)) {
+      playlist->count = intake.count;
+      playlist->waiting = waits;
+      Serial.printf("Playlist: %d frames stored\n", intake.count);
+    }
+    if (waits) {
+      Serial.printf("Playlist: first frame due in %ld s\n",
+                    (long)playlist->entries[0].displayAt - (long)intake.now);
+    } else if (intake.decoded == 0) {
+      memcpy(imageBuffer, remoteDecodeBuffer, REMOTE_BUFFER_SIZE);
+      *imageSize = intake.firstSize;
+      *imageFlags = intake.flags;
+    } else if (sdLoadFrame(0, imageBuffer, REMOTE_BUFFER_SIZE, imageSize,
+                           imageFlags)) {
+      padRemoteImage(imageBuffer, *imageSize, *imageFlags);
+    } else {
+      clearPlaylist(*playlist);
+      response.isRemote = false;
+    }
+  } else if (singleSeen) {
+    // Single image
+    clearPlaylist(*playlist);
+    if (!imageOk) {
+      response.isRemote = false;
+    } else if (singleSize > 0) {
+      memcpy(imageBuffer, remoteDecodeBuffer, REMOTE_BUFFER_SIZE);
+      *imageSize = singleSize;
+      *imageFlags = intake.flags;
+    }
+  }
 
-  Serial.println("Remote image drawn");
+  Serial.printf("Remote mode active, refresh: %ds\n",
+                response.refreshSeconds);
+  return response;
 }
 
 #endif // REMOTE_MODE_H
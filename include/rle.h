@@ -0,0 +1,103 @@
+#ifndef RLE_H
+#define RLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// PackBits run-length coding for 1bpp frames (mostly long white runs).
+// Header byte n: 0..127 -> n+1 literal bytes follow,
+//                -1..-127 -> next byte repeated 1-n times, -128 -> no-op.
+
+// Encode len bytes from in, passing output chunks to sink(data, len).
+// Returns the encoded size.
+template <typename Sink>
+inline size_t rleEncode(const uint8_t *in, size_t len, Sink sink) {
+  size_t written = 0;
+  size_t i = 0;
+
+  while (i < len) {
+    // Repeat run
+    size_t run = 1;
+    while (i + run < len && run < 128 && in[i + run] == in[i]) {
+      run++;
+    }
+
+    if (run >= 2) {
+      uint8_t packet[2] = {(uint8_t)(257 - run), in[i]};
+      sink(packet, 2);
+      written += 2;
+      i += run;
+      continue;
+    }
+
+    // Literal run, stops before the next repeat of 3 or more
+    size_t start = i;
+    size_t count = 0;
+    while (i < len && count < 128) {
+      if (i + 2 < len && in[i] == in[i + 1] && in[i] == in[i + 2])
+        break;
+      i++;
+      count++;
+    }
+
+    uint8_t header = (uint8_t)(count - 1);
+    sink(&header, 1);
+    sink(in + start, count);
+    written += 1 + count;
+  }
+
+  return written;
+}
+
+// Streaming decoder, so compressed data can be fed in small chunks
+class RleDecoder {
+private:
+  uint8_t *out;
+  size_t maxLen;
+  size_t pos;
+  uint8_t literalLeft;
+  uint8_t repeatCount;
+  bool overflow;
+
+  void put(uint8_t b) {
+    if (pos < maxLen) {
+      out[pos++] = b;
+    } else {
+      overflow = true;
+    }
+  }
+
+public:
+  RleDecoder(uint8_t *out, size_t maxLen)
+      : out(out), maxLen(maxLen), pos(0), literalLeft(0), repeatCount(0),
+        overflow(false) {}
+
+  void feed(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      uint8_t b = data[i];
+      if (literalLeft > 0) {
+        put(b);
+        literalLeft--;
+      } else if (repeatCount > 0) {
+        for (uint8_t n = 0; n < repeatCount; n++) {
+          put(b);
+        }
+        repeatCount = 0;
+      } else {
+        int8_t header = (int8_t)b;
+        if (header >= 0) {
+          literalLeft = header + 1;
+        } else if (header != -128) {
+          repeatCount = 1 - header;
+        }
+      }
+    }
+  }
+
+  size_t size() const { return pos; }
+
+  // True when the stream ended cleanly and fit in the output buffer
+  bool ok() const { return !overflow && literalLeft == 0 && repeatCount == 0; }
+};
+
+#endif // RLE_H
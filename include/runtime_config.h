@@ -0,0 +1,154 @@
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include "config.h"
+#include "wake_budget.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Preferences.h>
+
+// Runtime tunables. The #defines in config.h are the defaults; the remote
+// endpoint can override them with a versioned "config" object, which is
+// validated as a whole and stored in NVS as one blob (written atomically).
+// A copy lives in RTC memory so NVS is only read after power-on.
+//
+// "config": {"version": 3, "sleep_sec": 120, "weather_update_min": 30,
+//            "ghost_max_partials": 60, "remote_check_cycles": 5,
+//            "remote_refresh_sec": 60, "location": "Porto,PT",
+//            "weather_api_url": "https://..."}
+// Any field may be left out to keep its current value.
+
+#define RUNTIME_CONFIG_MAGIC 0xC0F10002 // Changes with the struct layout
+#define RUNTIME_CONFIG_NAMESPACE "config"
+#define RUNTIME_CONFIG_KEY "cfg"
+
+struct RuntimeConfig {
+  uint32_t magic;             // RUNTIME_CONFIG_MAGIC once loaded
+  uint16_t version;           // Server config version (0 = defaults)
+  uint16_t sleepSec;          // SLEEP_DURATION_SEC
+  uint16_t weatherUpdateMin;  // WEATHER_UPDATE_MIN
+  uint16_t ghostMaxPartials;  // GHOST_MAX_PARTIALS
+  uint16_t remoteCheckCycles; // REMOTE_CHECK_CYCLES
+  uint16_t remoteRefreshSec;  // REMOTE_REFRESH_SEC
+  char location[48];          // WEATHER_LOCATION
+  char weatherApiUrl[96];     // WEATHER_API_URL
+};
+
+inline void setRuntimeDefaults(RuntimeConfig &config) {
+  memset(&config, 0, sizeof(config));
+  config.magic = RUNTIME_CONFIG_MAGIC;
+  config.sleepSec = SLEEP_DURATION_SEC;
+  config.weatherUpdateMin = WEATHER_UPDATE_MIN;
+  config.ghostMaxPartials = GHOST_MAX_PARTIALS;
+  config.remoteCheckCycles = REMOTE_CHECK_CYCLES;
+  config.remoteRefreshSec = REMOTE_REFRESH_SEC;
+  strncpy(config.location, WEATHER_LOCATION, sizeof(config.location) - 1);
+  strncpy(config.weatherApiUrl, WEATHER_API_URL,
+          sizeof(config.weatherApiUrl) - 1);
+}
+
+// Printable, no spaces (goes into a URL as-is)
+inline bool isUrlSafe(const char *s) {
+  for (; *s; s++) {
+    if (*s <= ' ' || *s > '~')
+      return false;
+  }
+  return true;
+}
+
+// Whole-config sanity check, applied before anything is stored
+inline bool validateRuntimeConfig(const RuntimeConfig &config) {
+  return config.magic == RUNTIME_CONFIG_MAGIC && config.sleepSec >= 10 &&
+         config.sleepSec <= 3600 && config.weatherUpdateMin >= 5 &&
+         config.weatherUpdateMin <= 1440 && config.ghostMaxPartials >= 1 &&
+         config.remoteCheckCycles >= 1 && config.remoteRefreshSec >= 10 &&
+         config.remoteRefreshSec <= 43200 && strlen(config.location) > 0 &&
+         isUrlSafe(config.location) &&
+         (strncmp(config.weatherApiUrl, "http://", 7) == 0 ||
+          strncmp(config.weatherApiUrl, "https://", 8) == 0) &&
+         isUrlSafe(config.weatherApiUrl);
+}
+
+// Make sure config holds something usable: keep the RTC copy, else load
+// the NVS blob, else fall back to the defaults
+inline void loadRuntimeConfig(RuntimeConfig &config) {
+  if (config.magic == RUNTIME_CONFIG_MAGIC)
+    return;
+
+  RuntimeConfig stored;
+  Preferences prefs;
+  bool ok = prefs.begin(RUNTIME_CONFIG_NAMESPACE, true) &&
+            prefs.getBytesLength(RUNTIME_CONFIG_KEY) == sizeof(stored) &&
+            prefs.getBytes(RUNTIME_CONFIG_KEY, &stored, sizeof(stored)) ==
+                sizeof(stored) &&
+            validateRuntimeConfig(stored);
+  prefs.end();
+
+  if (ok) {
+    config = stored;
+    Serial.printf("Config: version %d from NVS\n", config.version);
+  } else {
+    setRuntimeDefaults(config);
+    Serial.println("Config: using build defaults");
+  }
+}
+
+// Copy a JSON string field if present; false if it does not fit
+inline bool copyConfigString(JsonVariant value, char *dest, size_t size) {
+  if (value.isNull())
+    return true;
+  const char *s = value.as<const char *>();
+  if (!s || strlen(s) >= size)
+    return false;
+  strcpy(dest, s);
+  return true;
+}
+
+// Apply a "config" object from the server. Only newer versions are taken;
+// the candidate is built and validated in full before it replaces the
+// current config, so a bad blob never leaves a half-applied state.
+inline bool applyRuntimeConfig(JsonObject json, RuntimeConfig &config) {
+  if (json.isNull() || !json["version"].is<int>())
+    return false;
+  int version = json["version"];
+  if (version <= config.version)
+    return false;
+
+  RuntimeConfig candidate = config;
+  candidate.version = version;
+  candidate.sleepSec = json["sleep_sec"] | candidate.sleepSec;
+  candidate.weatherUpdateMin =
+      json["weather_update_min"] | candidate.weatherUpdateMin;
+  candidate.ghostMaxPartials =
+      json["ghost_max_partials"] | candidate.ghostMaxPartials;
+  candidate.remoteCheckCycles =
+      json["remote_check_cycles"] | candidate.remoteCheckCycles;
+  candidate.remoteRefreshSec =
+      json["remote_refresh_sec"] | candidate.remoteRefreshSec;
+
+  if (!copyConfigString(json["location"], candidate.location,
+                        sizeof(candidate.location)) ||
+      !copyConfigString(json["weather_api_url"], candidate.weatherApiUrl,
+                        sizeof(candidate.weatherApiUrl)) ||
+      !validateRuntimeConfig(candidate)) {
+    Serial.printf("Config: version %d rejected (invalid)\n", version);
+    return false;
+  }
+
+  WakeLimitHold hold; // Not cut off halfway by the wake's hard limit
+  Preferences prefs;
+  bool saved = prefs.begin(RUNTIME_CONFIG_NAMESPACE, false) &&
+               prefs.putBytes(RUNTIME_CONFIG_KEY, &candidate,
+                              sizeof(candidate)) == sizeof(candidate);
+  prefs.end();
+  if (!saved) {
+    Serial.println("Config: NVS write failed, keeping current config");
+    return false;
+  }
+
+  config = candidate;
+  Serial.printf("Config: version %d applied\n", version);
+  return true;
+}
+
+#endif // RUNTIME_CONFIG_H
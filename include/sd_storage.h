@@ -0,0 +1,155 @@
+#ifndef SD_STORAGE_H
+#define SD_STORAGE_H
+
+#include "config.h"
+#include "rle.h"
+#include "wake_budget.h"
+#include <Arduino.h>
+#include <FS.h>
+#include <SD.h>
+#include <SPI.h>
+
+// SD card storage for cached frames and the telemetry log.
+// The card is only mounted on wakes that actually need it (first call to
+// sdMount()) and unmounted again before deep sleep. Writes hold off the
+// wake's hard limit, so it never cuts a FAT update in half.
+
+#define SD_FRAMES_DIR "/frames"
+// Starts with a TelemetryUploadHeader. Firmware before TELEMETRY_VERSION
+// 2 wrote bare 16-byte records to /telemetry.bin, which is left alone.
+#define SD_TELEMETRY_FILE "/telemetry2.bin"
+
+#define SD_FRAME_MAGIC 0x4D52464D // "MFRM"
+
+// Header stored in front of every cached frame; the image data that
+// follows is PackBits compressed (see rle.h)
+struct SdFrameHeader {
+  uint32_t magic;
+  uint16_t size;  // uncompressed image bytes
+  uint8_t flags;  // REMOTE_IMAGE_* flags
+  uint8_t reserved;
+};
+
+// The SD slot has its own pins, so it gets the HSPI peripheral
+static SPIClass sdSPI(HSPI);
+static bool sdMounted = false;
+static bool sdFailed = false;
+
+// Mount the card on first use; later calls are free
+inline bool sdMount() {
+  if (sdMounted)
+    return true;
+  if (sdFailed)
+    return false; // Don't retry (and wait) again on the same wake
+
+  WakeLimitHold hold;
+  sdSPI.begin(SDCARD_CLK, SDCARD_MISO, SDCARD_MOSI, SDCARD_SS);
+  if (!SD.begin(SDCARD_SS, sdSPI)) {
+    Serial.println("SD card mount failed");
+    sdSPI.end();
+    sdFailed = true;
+    return false;
+  }
+
+  SD.mkdir(SD_FRAMES_DIR);
+  sdMounted = true;
+  Serial.println("SD card mounted");
+  return true;
+}
+
+// Unmount before deep sleep (no-op if the card was not used this wake)
+inline void sdUnmount() {
+  if (!sdMounted)
+    return;
+  SD.end();
+  sdSPI.end();
+  sdMounted = false;
+}
+
+inline void sdFramePath(char *path, size_t len, int slot) {
+  snprintf(path, len, SD_FRAMES_DIR "/%03d.bin", slot);
+}
+
+// Save a pre-rendered frame to a numbered slot
+inline bool sdSaveFrame(int slot, const uint8_t *image, size_t size,
+                        uint8_t flags) {
+  if (!sdMount())
+    return false;
+
+  WakeLimitHold hold;
+  char path[32];
+  sdFramePath(path, sizeof(path), slot);
+  File file = SD.open(path, FILE_WRITE);
+  if (!file) {
+    Serial.printf("SD: cannot write %s\n", path);
+    return false;
+  }
+
+  SdFrameHeader header = {SD_FRAME_MAGIC, (uint16_t)size, flags, 0};
+  bool ok = file.write((const uint8_t *)&header, sizeof(header)) ==
+            sizeof(header);
+  size_t packed = rleEncode(image, size, [&](const uint8_t *data, size_t len) {
+    if (file.write(data, len) != len)
+      ok = false;
+  });
+  file.close();
+
+  Serial.printf("SD: frame %d saved (%d -> %d bytes)\n", slot, size, packed);
+  return ok;
+}
+
+// Load a frame from a slot into buffer (maxSize bytes)
+inline bool sdLoadFrame(int slot, uint8_t *buffer, size_t maxSize,
+                        size_t *size, uint8_t *flags) {
+  if (!sdMount())
+    return false;
+
+  char path[32];
+  sdFramePath(path, sizeof(path), slot);
+  File file = SD.open(path, FILE_READ);
+  if (!file)
+    return false;
+
+  SdFrameHeader header;
+  bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+            header.magic == SD_FRAME_MAGIC && header.size <= maxSize;
+
+  if (ok) {
+    // Decompress in small chunks straight into the destination
+    RleDecoder decoder(buffer, header.size);
+    uint8_t chunk[128];
+    size_t n;
+    while ((n = file.read(chunk, sizeof(chunk))) > 0) {
+      decoder.feed(chunk, n);
+    }
+    ok = decoder.ok() && decoder.size() == header.size;
+  }
+  file.close();
+
+  if (ok) {
+    *size = header.size;
+    *flags = header.flags;
+  }
+  return ok;
+}
+
+// Whether a file exists
+inline bool sdExists(const char *path) {
+  return sdMount() && SD.exists(path);
+}
+
+// Append raw bytes to a file (used for the telemetry log)
+inline bool sdAppendFile(const char *path, const uint8_t *data, size_t len) {
+  if (!sdMount())
+    return false;
+
+  WakeLimitHold hold;
+  File file = SD.open(path, FILE_APPEND);
+  if (!file)
+    return false;
+  bool ok = file.write(data, len) == len;
+  file.close();
+  return ok;
+}
+
+#endif // SD_STORAGE_H
@@ -4,6 +4,7 @@
 #include "config.h"
 #include <Arduino.h>
 #include <esp_sleep.h>
+#include <time.h>
 
 // Get the reason we woke up from sleep
 inline esp_sleep_wakeup_cause_t getWakeupReason() {
@@ -70,6 +71,57 @@ inline void configureSleepDuration(int durationSec) {
   Serial.printf("Sleep configured: timer=%ds, button=GPIO39\n", durationSec);
 }
 
+// Configure sleep with no timer - only the button wakes the device
+// (critical battery: nothing should drain it further)
+inline void configureButtonOnlySleep() {
+  esp_sleep_enable_ext0_wakeup(GPIO_NUM_39, 0);
+
+  Serial.println("Sleep configured: button=GPIO39 only");
+}
+
+// ==================== Server Schedule Hints ====================
+// Deadlines are local time(nullptr) values. The RTC keeps counting through
+// deep sleep, so they stay valid across wakes (even before NTP sync).
+struct ScheduleHints {
+  uint32_t nextRemoteCheck;   // Don't poll the remote endpoint before this
+  uint32_t remoteValidUntil;  // Remote content unchanged until this
+  uint32_t weatherValidUntil; // Weather data fresh until this
+};
+
+// Turn a server delay into a local deadline, clamped by local policy.
+// Returns 0 (no hint) for negative delays.
+inline uint32_t hintDeadline(long delaySec) {
+  if (delaySec < 0)
+    return 0;
+  delaySec = constrain(delaySec, (long)HINT_MIN_DELAY_SEC,
+                       (long)HINT_MAX_DELAY_SEC);
+  return (uint32_t)time(nullptr) + delaySec;
+}
+
+// True while a hint deadline is set and still in the future
+inline bool hintPending(uint32_t deadline) {
+  return deadline != 0 && (uint32_t)time(nullptr) < deadline;
+}
+
+// Seconds from now until deadline (0 if passed or unset)
+inline int secondsUntil(uint32_t deadline) {
+  uint32_t now = time(nullptr);
+  return (deadline > now) ? deadline - now : 0;
+}
+
+// Remote mode sleep: wake when the content expires, but never before the
+// server's next_check; fall back to refresh_seconds without hints
+inline int hintedRemoteSleep(const ScheduleHints &hints, int refreshSec) {
+  int sleepSec = refreshSec;
+  if (hintPending(hints.remoteValidUntil)) {
+    sleepSec = secondsUntil(hints.remoteValidUntil);
+  }
+  if (hintPending(hints.nextRemoteCheck)) {
+    sleepSec = max(sleepSec, secondsUntil(hints.nextRemoteCheck));
+  }
+  return constrain(sleepSec, 1, HINT_MAX_DELAY_SEC);
+}
+
 // Enter deep sleep mode
 // Note: This function does not return - device restarts on wake
 inline void enterDeepSleep() {
@@ -0,0 +1,152 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "config.h"
+#include "dns_cache.h"
+#include "energy_model.h"
+#include "sd_storage.h"
+#include "tls_client.h"
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFi.h>
+
+// Per-wake telemetry. Records are collected in RTC memory and sent in one
+// POST to TELEMETRY_URL on a wake that already has WiFi up, so uploading
+// costs no extra radio time. Without an endpoint (or while uploads fail)
+// they are appended to the SD card log whenever the RTC buffer fills up.
+// tools/telemetry_receiver.py decodes uploads.
+
+#define TELEMETRY_LOG_SIZE 16
+#define TELEMETRY_MAGIC 0x314D4C54 // "TLM1", little endian
+#define TELEMETRY_VERSION 2
+
+// Record flags
+#define TELEMETRY_WIFI_OK 0x01
+#define TELEMETRY_WEATHER_OK 0x02
+#define TELEMETRY_REMOTE_OK 0x04
+#define TELEMETRY_REMOTE_MODE 0x08
+#define TELEMETRY_TIME_OK 0x10
+#define TELEMETRY_DEFERRED 0x20 // Wake budget put off queued work
+#define TELEMETRY_OVERRUN 0x40  // Previous wake hit the hard limit
+
+// Compact binary record (20 bytes, written as-is, little endian)
+struct TelemetryRecord {
+  uint32_t bootCount;
+  uint32_t timestamp;   // Unix time, 0 if clock not set
+  uint16_t wakeMs;      // Active time of the wake
+  uint16_t batteryMv;
+  int8_t rssi;          // 0 when WiFi was not connected
+  uint8_t flags;        // TELEMETRY_* bits
+  uint8_t wakeReason;   // esp_sleep_wakeup_cause_t
+  uint8_t powerState;   // PowerState at the end of the wake
+  uint8_t resetReason;  // esp_reset_reason_t
+  uint8_t httpFailures; // Failed HTTP requests during the wake
+  uint16_t reserved;
+};
+
+// Upload body: this header followed by count records. The SD log starts
+// with one too (count 0: records run to the end of the file).
+struct TelemetryUploadHeader {
+  uint32_t magic;     // TELEMETRY_MAGIC
+  uint8_t version;    // TELEMETRY_VERSION
+  uint8_t recordSize; // sizeof(TelemetryRecord)
+  uint8_t count;
+  uint8_t reserved;
+  uint8_t mac[6];     // Station MAC, identifies the device
+  uint16_t reserved2;
+};
+
+// RTC-compatible pending record buffer
+struct TelemetryLog {
+  uint8_t count;
+  TelemetryRecord records[TELEMETRY_LOG_SIZE];
+};
+
+inline TelemetryUploadHeader telemetryHeader(uint8_t count) {
+  TelemetryUploadHeader header = {};
+  header.magic = TELEMETRY_MAGIC;
+  header.version = TELEMETRY_VERSION;
+  header.recordSize = sizeof(TelemetryRecord);
+  header.count = count;
+  WiFi.macAddress(header.mac);
+  return header;
+}
+
+// Write all pending records to the SD log
+inline bool telemetryFlushToSd(TelemetryLog &log) {
+  if (log.count == 0)
+    return true;
+
+  // A new log gets the header first, so readers know the record layout
+  if (sdMount() && !sdExists(SD_TELEMETRY_FILE)) {
+    TelemetryUploadHeader header = telemetryHeader(0);
+    sdAppendFile(SD_TELEMETRY_FILE, (const uint8_t *)&header,
+                 sizeof(header));
+  }
+  if (!sdAppendFile(SD_TELEMETRY_FILE, (const uint8_t *)log.records,
+                    log.count * sizeof(TelemetryRecord))) {
+    Serial.println("Telemetry: SD append failed");
+    return false;
+  }
+
+  Serial.printf("Telemetry: %d records written to SD\n", log.count);
+  log.count = 0;
+  return true;
+}
+
+// True when enough records are pending to be worth a POST
+inline bool telemetryUploadDue(const TelemetryLog &log) {
+  return strlen(TELEMETRY_URL) > 0 && log.count >= TELEMETRY_UPLOAD_MIN;
+}
+
+// Send all pending records in one POST (WiFi must already be connected)
+inline bool telemetryUpload(TelemetryLog &log, DnsCache &dns,
+                            TlsSessionCache &tls) {
+  if (log.count == 0 || WiFi.status() != WL_CONNECTED)
+    return false;
+
+  uint8_t body[sizeof(TelemetryUploadHeader) +
+               TELEMETRY_LOG_SIZE * sizeof(TelemetryRecord)];
+  TelemetryUploadHeader header = telemetryHeader(log.count);
+  memcpy(body, &header, sizeof(header));
+  size_t length = sizeof(header) + log.count * sizeof(TelemetryRecord);
+  memcpy(body + sizeof(header), log.records, length - sizeof(header));
+
+  WiFiClient plainClient;
+  ResumableTlsClient tlsClient(TELEMETRY_URL, tls);
+  WiFiClient &client = isHttpsUrl(TELEMETRY_URL) ? tlsClient : plainClient;
+  HTTPClient http;
+
+  setPowerPhase(PHASE_NETWORK);
+  bool connected = beginCached(http, client, TELEMETRY_URL, dns);
+  http.setTimeout(5000);
+  http.addHeader("Content-Type", "application/octet-stream");
+  if (connected)
+    countHttpRequest();
+  int httpCode = connected ? http.POST(body, length)
+                           : HTTPC_ERROR_CONNECTION_REFUSED;
+  http.end();
+  setPowerPhase(PHASE_COMPUTE);
+
+  if (httpCode < 200 || httpCode >= 300) {
+    Serial.printf("Telemetry: upload failed (%d)\n", httpCode);
+    return false;
+  }
+
+  Serial.printf("Telemetry: %d records uploaded\n", log.count);
+  log.count = 0;
+  return true;
+}
+
+// Add a record; flushes to SD when the RTC buffer is full
+inline void telemetryAppend(TelemetryLog &log, const TelemetryRecord &record) {
+  if (log.count >= TELEMETRY_LOG_SIZE && !telemetryFlushToSd(log)) {
+    // No card: drop the oldest record
+    memmove(&log.records[0], &log.records[1],
+            (TELEMETRY_LOG_SIZE - 1) * sizeof(TelemetryRecord));
+    log.count = TELEMETRY_LOG_SIZE - 1;
+  }
+  log.records[log.count++] = record;
+}
+
+#endif // TELEMETRY_H
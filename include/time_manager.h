@@ -3,6 +3,7 @@
 
 #include "config.h"
 #include <Arduino.h>
+#include <sys/time.h>
 #include <time.h>
 
 // Global time info structure
@@ -15,8 +16,91 @@ static const char *weeksday[] = {"Dom", "Seg", "Ter", "Qua", "Qui", "Sex", "Sab"
 static const char *months[] = {"Jan", "Fev", "Mar", "Abr", "Mai", "Jun",
                                "Jul", "Ago", "Set", "Out", "Nov", "Dez"};
 
-// Sync time from NTP server
-inline bool syncTime() {
+// Refresh timeInfo and the formatted strings from the system clock
+// Format a given UTC time (the host frame renderer draws other times)
+inline void updateTimeStrings(time_t utc) {
+  time_t now = utc + GMT_OFFSET_SEC + DAYLIGHT_OFFSET_SEC;
+  gmtime_r(&now, &timeInfo);
+
+  strftime(timeStr, sizeof(timeStr), "%H:%M", &timeInfo);
+  snprintf(dateStr, sizeof(dateStr), "%s, %02d %s %d",
+           weeksday[timeInfo.tm_wday], timeInfo.tm_mday,
+           months[timeInfo.tm_mon], timeInfo.tm_year + 1900);
+  dayOfYear = timeInfo.tm_yday;
+}
+
+inline void updateTimeStrings() { updateTimeStrings(time(nullptr)); }
+
+// Days since 1970-01-01 for a civil date (no timegm() in newlib)
+inline long daysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  long era = (y >= 0 ? y : y - 399) / 400;
+  long yoe = y - era * 400;
+  long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+// Parse an HTTP Date header ("Sun, 06 Nov 1994 08:49:37 GMT")
+// Returns Unix time, or 0 if the header is missing or malformed
+inline time_t parseHttpDate(const char *date) {
+  static const char *names[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+  int day, year, hour, minute, second;
+  char mon[4];
+
+  if (!date || sscanf(date, "%*3s, %d %3s %d %d:%d:%d", &day, mon, &year,
+                      &hour, &minute, &second) != 6) {
+    return 0;
+  }
+
+  for (int m = 0; m < 12; m++) {
+    if (strcmp(mon, names[m]) == 0) {
+      return daysFromCivil(year, m + 1, day) * 86400L + hour * 3600L +
+             minute * 60L + second;
+    }
+  }
+  return 0;
+}
+
+// Accept a trusted timestamp from a server response (HTTP Date header or
+// a JSON field). Sets the clock if it drifted; lastSync records when.
+inline bool setTimeFromServer(time_t serverTime, uint32_t *lastSync) {
+  if (serverTime < 1000000000) {
+    return false;
+  }
+
+  long drift = (long)(serverTime - time(nullptr));
+  if (drift > TIME_DRIFT_MAX_SEC || drift < -TIME_DRIFT_MAX_SEC) {
+    struct timeval tv = {serverTime, 0};
+    settimeofday(&tv, nullptr);
+    Serial.printf("Clock set from server time (drift %lds)\n", drift);
+  }
+
+  *lastSync = serverTime;
+  updateTimeStrings();
+  return true;
+}
+
+// Make sure the clock is valid. Uses the RTC when a server timestamp was
+// seen within TIME_MAX_AGE_SEC, otherwise falls back to NTP. Without
+// network (allowNtp = false) an already set RTC is used as is.
+inline bool syncTime(uint32_t *lastSync, bool allowNtp) {
+  time_t now = time(nullptr);
+  bool recent = *lastSync != 0 && now >= (time_t)*lastSync &&
+                now - *lastSync < TIME_MAX_AGE_SEC;
+
+  if (recent || (!allowNtp && now > 1000000000)) {
+    updateTimeStrings();
+    Serial.printf("Time from RTC: %s %s\n", dateStr, timeStr);
+    return true;
+  }
+
+  if (!allowNtp) {
+    Serial.println("Clock not set and no network for NTP");
+    return false;
+  }
+
   configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
 
   if (!getLocalTime(&timeInfo, 5000)) {
@@ -24,17 +108,20 @@ inline bool syncTime() {
     return false;
   }
 
-  // Update formatted strings
-  strftime(timeStr, sizeof(timeStr), "%H:%M", &timeInfo);
-  snprintf(dateStr, sizeof(dateStr), "%s, %02d %s %d",
-           weeksday[timeInfo.tm_wday], timeInfo.tm_mday,
-           months[timeInfo.tm_mon], timeInfo.tm_year + 1900);
-  dayOfYear = timeInfo.tm_yday;
+  *lastSync = time(nullptr);
+  updateTimeStrings();
 
   Serial.printf("Time synced: %s %s\n", dateStr, timeStr);
   return true;
 }
 
+// True when no trusted time source was seen within TIME_MAX_AGE_SEC
+inline bool timeSyncDue(uint32_t lastSync) {
+  time_t now = time(nullptr);
+  return lastSync == 0 || now < (time_t)lastSync ||
+         now - lastSync >= TIME_MAX_AGE_SEC;
+}
+
 // Get pointer to time info structure
 inline struct tm *getTimeInfo() {
   return &timeInfo;
@@ -0,0 +1,450 @@
+#ifndef TLS_CLIENT_H
+#define TLS_CLIENT_H
+
+#include "config.h"
+#include "dns_cache.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <fcntl.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/platform.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/x509_crt.h>
+
+// HTTPS client that resumes TLS sessions across deep sleep.
+// WiFiClientSecure offers no way to set a session before its handshake, so
+// this drives mbedtls directly on top of the WiFiClient socket. The
+// serialized session (ticket or session ID + master secret) is kept in RTC
+// memory, one slot per host; a full handshake only happens when resumption
+// is refused.
+//
+// The server must be pinned with TLS_CA_CERT or TLS_FINGERPRINT: https://
+// URLs are refused without one. The certificate is checked during the full
+// handshake and dropped from the cached session, so a resumed session was
+// verified when it was first established.
+//
+// HTTPClient reconnects through WiFiClient's non-virtual
+// connect(host, port, timeout), which opens plain TCP. connected() is
+// false once TLS is down and write() closes a socket that has no TLS on
+// it, so such a reconnect fails instead of sending in clear text. Connect
+// first (beginCached) and send one request per connection.
+
+#define TLS_SESSION_SLOTS 3  // Hosts resumed (least recently used replaced)
+#define TLS_SESSION_MAX 384  // Serialized session without the certificate
+#define TLS_HANDSHAKE_TIMEOUT_MS 10000
+
+struct TlsSessionSlot {
+  char host[DNS_HOST_MAX];
+  uint16_t length;   // 0 = empty
+  uint16_t lastUsed; // Cache clock when last offered or saved
+  uint8_t data[TLS_SESSION_MAX];
+};
+
+// RTC-compatible session cache
+struct TlsSessionCache {
+  uint16_t clock;
+  TlsSessionSlot slots[TLS_SESSION_SLOTS];
+};
+
+// mbedtls state for the one connection open at a time. Static, so the
+// contexts stay off the 8 KB loop task stack. The configuration, RNG and
+// CA chain are built on first use and kept for the wake; the SSL context
+// and its record buffers only live while a connection is open.
+struct TlsContext {
+  mbedtls_ssl_context ssl;
+  mbedtls_ssl_config conf;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_entropy_context entropy;
+  mbedtls_x509_crt ca;
+  mbedtls_net_context net;
+  bool configured;
+  bool inUse;
+};
+
+static TlsContext tlsContext;
+
+inline bool isHttpsUrl(const char *url) {
+  return strncmp(url, "https", 5) == 0;
+}
+
+inline bool tlsPinned() {
+  return strlen(TLS_CA_CERT) > 0 || strlen(TLS_FINGERPRINT) > 0;
+}
+
+// Fingerprint pinning: the leaf must hash to TLS_FINGERPRINT, the rest of
+// the chain (and its expiry or name flags) does not matter
+inline int verifyTlsFingerprint(void *, mbedtls_x509_crt *cert, int depth,
+                                uint32_t *flags) {
+  *flags = 0;
+  if (depth > 0)
+    return 0;
+
+  uint8_t digest[32];
+  mbedtls_sha256(cert->raw.p, cert->raw.len, digest, 0);
+  char hex[65];
+  for (int i = 0; i < 32; i++) {
+    snprintf(hex + i * 2, 3, "%02x", digest[i]);
+  }
+  if (strcasecmp(hex, TLS_FINGERPRINT) != 0) {
+    Serial.println("TLS: certificate fingerprint mismatch");
+    *flags = MBEDTLS_X509_BADCERT_NOT_TRUSTED;
+  }
+  return 0;
+}
+
+// Build the shared configuration once per wake
+inline bool configureTls() {
+  TlsContext &tls = tlsContext;
+  if (tls.configured)
+    return true;
+  if (!tlsPinned()) {
+    Serial.println("TLS: no TLS_CA_CERT or TLS_FINGERPRINT, https refused");
+    return false;
+  }
+
+  mbedtls_ssl_config_init(&tls.conf);
+  mbedtls_ctr_drbg_init(&tls.drbg);
+  mbedtls_entropy_init(&tls.entropy);
+  mbedtls_x509_crt_init(&tls.ca);
+  bool ok = mbedtls_ctr_drbg_seed(&tls.drbg, mbedtls_entropy_func,
+                                  &tls.entropy, NULL, 0) == 0 &&
+            mbedtls_ssl_config_defaults(&tls.conf, MBEDTLS_SSL_IS_CLIENT,
+                                        MBEDTLS_SSL_TRANSPORT_STREAM,
+                                        MBEDTLS_SSL_PRESET_DEFAULT) == 0;
+  mbedtls_ssl_conf_rng(&tls.conf, mbedtls_ctr_drbg_random, &tls.drbg);
+  mbedtls_ssl_conf_session_tickets(&tls.conf,
+                                   MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+
+  const char *caCert = TLS_CA_CERT;
+  if (!ok) {
+    Serial.println("TLS: setup failed");
+  } else if (strlen(caCert) > 0) {
+    // One or more PEM certificates
+    ok = mbedtls_x509_crt_parse(&tls.ca, (const unsigned char *)caCert,
+                                strlen(caCert) + 1) == 0;
+    if (!ok)
+      Serial.println("TLS: invalid TLS_CA_CERT");
+    mbedtls_ssl_conf_ca_chain(&tls.conf, &tls.ca, NULL);
+    mbedtls_ssl_conf_authmode(&tls.conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+  } else {
+    // No chain to verify against: the callback decides, and the result is
+    // checked before any data is sent
+    mbedtls_ssl_conf_verify(&tls.conf, verifyTlsFingerprint, NULL);
+    mbedtls_ssl_conf_authmode(&tls.conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
+  }
+
+  if (!ok) {
+    mbedtls_ssl_config_free(&tls.conf);
+    mbedtls_ctr_drbg_free(&tls.drbg);
+    mbedtls_entropy_free(&tls.entropy);
+    mbedtls_x509_crt_free(&tls.ca);
+    return false;
+  }
+  tls.configured = true;
+  return true;
+}
+
+class ResumableTlsClient : public WiFiClient {
+private:
+  TlsSessionCache &cache;
+  char host[DNS_HOST_MAX];
+  bool active;
+  int16_t peeked; // Byte held back by peek(), -1 if none
+
+  mbedtls_ssl_context &ssl;
+
+  void freeTls() {
+    mbedtls_ssl_free(&ssl);
+    tlsContext.inUse = false;
+    active = false;
+  }
+
+  bool setupTls() {
+    mbedtls_ssl_init(&ssl);
+    tlsContext.inUse = true;
+    active = true;
+    if (mbedtls_ssl_setup(&ssl, &tlsContext.conf) != 0 ||
+        mbedtls_ssl_set_hostname(&ssl, host) != 0) {
+      return false;
+    }
+
+    // Non-blocking socket, like the Arduino ssl_client
+    mbedtls_net_context &net = tlsContext.net;
+    net.fd = fd();
+    fcntl(net.fd, F_SETFL, fcntl(net.fd, F_GETFL, 0) | O_NONBLOCK);
+    mbedtls_ssl_set_bio(&ssl, &net, mbedtls_net_send, mbedtls_net_recv, NULL);
+    return true;
+  }
+
+  TlsSessionSlot *findSlot() {
+    for (int i = 0; i < TLS_SESSION_SLOTS; i++) {
+      if (cache.slots[i].length > 0 && strcmp(cache.slots[i].host, host) == 0)
+        return &cache.slots[i];
+    }
+    return nullptr;
+  }
+
+  void forgetSession() {
+    TlsSessionSlot *slot = findSlot();
+    if (slot)
+      slot->length = 0;
+  }
+
+  // Offer the cached session for this host
+  bool offerSession() {
+    TlsSessionSlot *slot = findSlot();
+    if (!slot)
+      return false;
+
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    bool ok = mbedtls_ssl_session_load(&session, slot->data, slot->length) ==
+                  0 &&
+              mbedtls_ssl_set_session(&ssl, &session) == 0;
+    mbedtls_ssl_session_free(&session);
+    if (ok)
+      slot->lastUsed = ++cache.clock;
+    return ok;
+  }
+
+  // Store the session in this host's slot, an empty one or the least
+  // recently used one
+  void saveSession() {
+    TlsSessionSlot *slot = findSlot();
+    if (!slot) {
+      for (int i = 0; i < TLS_SESSION_SLOTS; i++) {
+        TlsSessionSlot &other = cache.slots[i];
+        if (other.length == 0) {
+          slot = &other;
+          break;
+        }
+        if (!slot || (uint16_t)(cache.clock - other.lastUsed) >
+                         (uint16_t)(cache.clock - slot->lastUsed))
+          slot = &other;
+      }
+    }
+
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    size_t length = 0;
+    bool saved = false;
+    if (mbedtls_ssl_get_session(&ssl, &session) == 0) {
+#if defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+      // The certificate (1-2 KB) was verified in this handshake and is not
+      // needed to resume
+      if (session.peer_cert) {
+        mbedtls_x509_crt_free(session.peer_cert);
+        mbedtls_free(session.peer_cert);
+        session.peer_cert = NULL;
+      }
+#endif
+      saved = mbedtls_ssl_session_save(&session, slot->data,
+                                       sizeof(slot->data), &length) == 0;
+    }
+    mbedtls_ssl_session_free(&session);
+
+    if (!saved) {
+      if (length > sizeof(slot->data)) {
+        Serial.printf("TLS: session for %s too large to cache (%u > %d)\n",
+                      host, (unsigned)length, TLS_SESSION_MAX);
+      }
+      slot->length = 0;
+      return;
+    }
+    strncpy(slot->host, host, DNS_HOST_MAX - 1);
+    slot->host[DNS_HOST_MAX - 1] = '\0';
+    slot->length = length;
+    slot->lastUsed = ++cache.clock;
+    Serial.printf("TLS: session for %s cached (%u bytes)\n", host,
+                  (unsigned)length);
+  }
+
+  int handshake() {
+    unsigned long start = millis();
+    int ret;
+    while ((ret = mbedtls_ssl_handshake(&ssl)) != 0) {
+      if (ret != MBEDTLS_ERR_SSL_WANT_READ &&
+          ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+        return ret;
+      }
+      if (millis() - start > TLS_HANDSHAKE_TIMEOUT_MS) {
+        return MBEDTLS_ERR_SSL_TIMEOUT;
+      }
+      delay(2);
+    }
+    return 0;
+  }
+
+  // TCP is connected; run TLS, resuming the cached session if possible.
+  // Falls back to a full handshake on a fresh connection if resumption
+  // is rejected.
+  int startTls(IPAddress ip, uint16_t port, int32_t timeout) {
+    unsigned long start = millis();
+    if (!setupTls()) {
+      stop();
+      return 0;
+    }
+
+    bool offered = offerSession();
+    int ret = handshake();
+
+    if (ret != 0 && offered) {
+      Serial.printf("TLS: resumption failed (-0x%04x), full handshake\n",
+                    -ret);
+      forgetSession();
+      stop();
+      if (!WiFiClient::connect(ip, port, timeout) || !setupTls()) {
+        stop();
+        return 0;
+      }
+      offered = false;
+      ret = handshake();
+    }
+
+    if (ret != 0) {
+      Serial.printf("TLS: handshake failed (-0x%04x)\n", -ret);
+      stop();
+      return 0;
+    }
+
+    if (mbedtls_ssl_get_verify_result(&ssl) != 0) {
+      Serial.println("TLS: server certificate not trusted");
+      forgetSession();
+      stop();
+      return 0;
+    }
+
+    saveSession();
+    Serial.printf("TLS: handshake in %lu ms (%s)\n", millis() - start,
+                  offered ? "cached session offered" : "full");
+    return 1;
+  }
+
+public:
+  ResumableTlsClient(const char *url, TlsSessionCache &cache)
+      : cache(cache), active(false), peeked(-1), ssl(tlsContext.ssl) {
+    uint16_t port;
+    if (!parseUrlHost(url, host, sizeof(host), &port)) {
+      host[0] = '\0';
+    }
+  }
+
+  ~ResumableTlsClient() { stop(); }
+
+  int connect(IPAddress ip, uint16_t port, int32_t timeout) {
+    if (!configureTls())
+      return 0;
+    if (tlsContext.inUse) {
+      Serial.println("TLS: another connection is open");
+      return 0;
+    }
+    if (!WiFiClient::connect(ip, port, timeout))
+      return 0;
+    return startTls(ip, port, timeout);
+  }
+
+  int connect(IPAddress ip, uint16_t port) override {
+    return connect(ip, port, 3000);
+  }
+
+  int connect(const char *hostname, uint16_t port, int32_t timeout) {
+    IPAddress ip;
+    if (!WiFi.hostByName(hostname, ip))
+      return 0;
+    return connect(ip, port, timeout);
+  }
+
+  int connect(const char *hostname, uint16_t port) override {
+    return connect(hostname, port, 3000);
+  }
+
+  size_t write(uint8_t b) override { return write(&b, 1); }
+
+  size_t write(const uint8_t *buf, size_t size) override {
+    if (!active) {
+      // A socket HTTPClient opened on its own: never send in clear text
+      if (WiFiClient::connected()) {
+        Serial.println("TLS: plain reconnect refused");
+        WiFiClient::stop();
+      }
+      return 0;
+    }
+    size_t sent = 0;
+    unsigned long start = millis();
+    while (sent < size) {
+      int ret = mbedtls_ssl_write(&ssl, buf + sent, size - sent);
+      if (ret > 0) {
+        sent += ret;
+      } else if ((ret != MBEDTLS_ERR_SSL_WANT_WRITE &&
+                  ret != MBEDTLS_ERR_SSL_WANT_READ) ||
+                 millis() - start > TLS_HANDSHAKE_TIMEOUT_MS) {
+        break;
+      }
+    }
+    return sent;
+  }
+
+  int available() override {
+    if (!active)
+      return 0;
+    int pending = peeked >= 0 ? 1 : 0;
+    // A zero length read processes incoming records without consuming
+    mbedtls_ssl_read(&ssl, NULL, 0);
+    return pending + mbedtls_ssl_get_bytes_avail(&ssl);
+  }
+
+  int read() override {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+  }
+
+  int read(uint8_t *buf, size_t size) override {
+    if (!active || size == 0)
+      return -1;
+    size_t n = 0;
+    if (peeked >= 0) {
+      buf[n++] = peeked;
+      peeked = -1;
+    }
+    if (n < size) {
+      int ret = mbedtls_ssl_read(&ssl, buf + n, size - n);
+      if (ret > 0) {
+        n += ret;
+      } else if (n == 0) {
+        return -1;
+      }
+    }
+    return n;
+  }
+
+  int peek() override {
+    if (peeked < 0) {
+      uint8_t b;
+      if (read(&b, 1) == 1)
+        peeked = b;
+    }
+    return peeked;
+  }
+
+  void flush() override {}
+
+  // Only a live TLS session counts, so HTTPClient never reuses a bare
+  // socket
+  uint8_t connected() override {
+    return active && (available() > 0 || WiFiClient::connected());
+  }
+
+  void stop() override {
+    if (active) {
+      mbedtls_ssl_close_notify(&ssl);
+      freeTls();
+    }
+    peeked = -1;
+    WiFiClient::stop();
+  }
+};
+
+#endif // TLS_CLIENT_H
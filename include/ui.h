@@ -5,105 +5,137 @@
 #include "config.h"
 #include "display_manager.h"
 #include "icons.h"
-#include "messages.h"
-#include "time_manager.h"
-#include "weather.h"
-#include "wifi_manager.h"
-
-// Draw status bar (WiFi + Battery) in top right corner
-inline void drawStatusBar(DisplayManager &display) {
-  int x = display.width() - 2;
-
-  // Battery icon (rightmost)
-  const unsigned char *battIcon;
-  if (isCharging()) {
-    battIcon = icon_battery_charging;
-  } else {
-    battIcon = getBatteryIcon(getBatteryPercentage());
-  }
-  x -= BATTERY_ICON_WIDTH;
-  display.drawBitmap(x, 8, battIcon, BATTERY_ICON_WIDTH, BATTERY_ICON_HEIGHT);
-
-  // Small gap
-  x -= 4;
-
-  // WiFi icon
-  x -= WIFI_ICON_WIDTH;
-  if (isWiFiConnected()) {
-    display.drawBitmap(x, 8, icon_wifi, WIFI_ICON_WIDTH, WIFI_ICON_HEIGHT);
-  } else {
-    display.drawBitmap(x, 8, icon_wifi_off, WIFI_ICON_WIDTH, WIFI_ICON_HEIGHT);
-  }
+#include "layout.h"
+#include "overlay.h"
+#include "remote_mode.h"
+#include "weather_view.h"
+#include "widgets.h"
+
+// Screens on the panel: what to redraw and how to refresh it. The widgets
+// themselves are drawn by widgets.h.
+
+// wifiOnline: outcome of the last WiFi connect. The radio is usually off
+// (or not up yet) while drawing, so the live link state would flicker.
+inline ScreenData gatherScreenData(const WeatherView &view,
+                                   bool showMorningMessage, bool wifiOnline) {
+  const unsigned char *batteryIcon =
+      isCharging() ? icon_battery_charging
+                   : getBatteryIcon(getBatteryPercentage());
+  return makeScreenData(view, showMorningMessage, wifiOnline, batteryIcon);
 }
 
-// Draw the main screen with weather, time, and messages
-inline void drawMainScreen(DisplayManager &display, WeatherClient &weather,
-                           bool showMorningMessage) {
+// Render the main screen with weather, time, and messages into the
+// framebuffer (no panel refresh)
+inline void renderMainScreen(DisplayManager &display, const WeatherView &view,
+                             bool showMorningMessage, bool wifiOnline) {
+  ScreenData data = gatherScreenData(view, showMorningMessage, wifiOnline);
   display.clear();
+  renderWidgets(display, data, ALL_WIDGETS);
+}
 
-  // Draw status bar (WiFi + Battery) in top right
-  drawStatusBar(display);
-
-  // === Top section: Weather info ===
-  if (weather.isValid()) {
-    WeatherData w = weather.getWeather();
-
-    // Weather icon based on condition
-    const unsigned char *icon = getWeatherIcon(w.condition, w.isDay);
-    display.drawBitmap(2, 2, icon, ICON_WIDTH, ICON_HEIGHT);
-
-    // Temperature (big) next to icon
-    display.setFont(&FreeMonoBold18pt7b);
-    display.drawTextAt(weather.getTemperatureString(), 48, 30);
-
-    // Condition text (max 10 chars)
-    display.setFont(&FreeSans9pt7b);
-    char condTrunc[11];
-    strncpy(condTrunc, w.condition, 10);
-    condTrunc[10] = '\0';
-    display.drawTextAt(condTrunc, 48, 48);
-
-    // Min/Max temperature
-    display.drawTextAt(weather.getMinMaxString(), 150, 30);
+// Draw the main screen and refresh the panel. Only widgets whose key
+// changed since the last draw are redrawn, with one refresh of the area
+// they cover (partial, clean or full as the refresh scheduler decides);
+// an unknown panel state redraws everything with a full refresh.
+inline void drawMainScreen(DisplayManager &display, const WeatherView &view,
+                           bool showMorningMessage, bool wifiOnline,
+                           LayoutState &state) {
+  ScreenData data = gatherScreenData(view, showMorningMessage, wifiOnline);
+
+  uint32_t keys[WIDGET_SOURCE_COUNT];
+  memcpy(keys, state.keys, sizeof(keys));
+  WidgetMask changed = 0;
+  for (size_t i = 0; i < MAIN_WIDGET_COUNT; i++) {
+    WidgetSource source = MAIN_LAYOUT[i].source;
+    keys[source] = widgetKey(source, data);
+    if (keys[source] != state.keys[source]) {
+      changed |= 1 << i;
+    }
+  }
 
-    // Rain chance
-    char rainStr[15];
-    snprintf(rainStr, sizeof(rainStr), "Chuva: %d%%", weather.getChanceOfRain());
-    display.drawTextAt(rainStr, 150, 48);
+  display.clear();
+  if (!state.valid) {
+    renderWidgets(display, data, ALL_WIDGETS);
+    display.update();
+  } else if (changed) {
+    // The refresh window is widened to whole bytes of panel RAM, so
+    // neighbours reaching into it are drawn as well
+    WidgetRect area = widgetBounds(changed);
+    RefreshKind kind = display.planRefresh(area.x, area.y, area.w, area.h);
+    renderWidgets(display, data,
+                  kind == REFRESH_FULL ? ALL_WIDGETS
+                                       : widgetsTouching(area, 8));
+    display.refresh(kind, area.x, area.y, area.w, area.h);
+    Serial.printf("Display: %s refresh %dx%d at %d,%d\n",
+                  REFRESH_KIND_NAMES[kind], area.w, area.h, area.x, area.y);
+  } else {
+    Serial.println("Display: nothing changed");
+  }
 
-    // Toggle between morning message and day suggestion
-    String messageToShow = "";
+  memcpy(state.keys, keys, sizeof(keys));
+  state.valid = true;
+}
 
-    if (isMorning() && showMorningMessage) {
-      messageToShow = getMorningMessage(getDayOfYear());
-    } else {
-      messageToShow = weather.getDaySuggestion();
+// Draw a remote frame with its local overlays on top. full: new frame (or
+// unknown panel state), full refresh. Otherwise only the overlays whose
+// key changed are refreshed, in one window planned by the scheduler. The
+// image is copied straight into the framebuffer; imageBuffer (the RTC
+// copy) is never modified, so it can be redrawn on later wakes.
+inline void drawRemoteScreen(DisplayManager &display,
+                             const uint8_t *imageBuffer, uint8_t imageFlags,
+                             RemoteOverlays &overlays,
+                             const WeatherView &view, bool wifiOnline,
+                             bool full) {
+  display.drawFullImage(imageBuffer, imageFlags & REMOTE_IMAGE_PANEL_LAYOUT,
+                        imageFlags & REMOTE_IMAGE_BLACK_IS_ONE);
+
+  // Every overlay is drawn so the byte-aligned window holds valid pixels
+  ScreenData data = gatherScreenData(view, false, wifiOnline);
+  WidgetRect changed = {0, 0, 0, 0};
+  for (uint8_t i = 0; i < overlays.count; i++) {
+    WidgetLayout widget = overlayWidget(overlays.items[i]);
+    uint32_t key = widgetKey(widget.source, data);
+    if (key != overlays.keys[i]) {
+      changed = unionRect(changed, widget.bounds);
+      overlays.keys[i] = key;
     }
+    display.fillRect(widget.bounds.x, widget.bounds.y, widget.bounds.w,
+                     widget.bounds.h, false);
+    drawWidget(display, widget, data);
+  }
 
-    if (messageToShow.length() > 0) {
-      if (messageToShow.length() > 25) {
-        display.setFont(&FreeSans9pt7b);
-      } else {
-        display.setFont(&FreeSansBold9pt7b);
-      }
-    }
-    display.drawText(messageToShow, 68, ALIGN_CENTER);
+  if (full || !overlays.drawn) {
+    display.update();
+    Serial.println("Remote image drawn");
+  } else if (changed.w > 0) {
+    // The whole frame is already in the framebuffer, so any kind works
+    RefreshKind kind =
+        display.planRefresh(changed.x, changed.y, changed.w, changed.h);
+    display.refresh(kind, changed.x, changed.y, changed.w, changed.h);
+    Serial.printf("Remote overlays: %s refresh %dx%d at %d,%d\n",
+                  REFRESH_KIND_NAMES[kind], changed.w, changed.h, changed.x,
+                  changed.y);
   } else {
-    // No weather data - draw placeholder
-    display.drawRect(2, 2, ICON_WIDTH, ICON_HEIGHT);
-    display.setFont(&FreeSans9pt7b);
-    display.drawTextAt("Clima: --", 48, 30);
+    Serial.println("Remote overlays unchanged");
   }
+  overlays.drawn = true;
+}
+
+// Final frame shown before the battery runs out. Drawn once with a full
+// refresh so the panel is left clean instead of half-drawn at brown-out.
+inline void drawLowBatteryScreen(DisplayManager &display) {
+  display.clear();
 
-  // Separator line
-  display.drawLine(0, 76, display.width(), 76);
+  display.drawBitmap((display.width() - BATTERY_ICON_WIDTH) / 2, 20,
+                     icon_battery_empty, BATTERY_ICON_WIDTH,
+                     BATTERY_ICON_HEIGHT);
 
-  // === Bottom section: Time and Date ===
-  display.setFont(&FreeMonoBold18pt7b);
-  display.drawText(getTimeStr(), 102, ALIGN_CENTER);
+  display.setFont(&FreeSansBold9pt7b);
+  display.drawText("Bateria fraca", 62, ALIGN_CENTER);
 
   display.setFont(&FreeSans9pt7b);
-  display.drawText(getDateStr(), 120, ALIGN_CENTER);
+  display.drawText("Carregue-me, por favor!", 90, ALIGN_CENTER);
+  display.drawText("Botao: atualizar", 114, ALIGN_CENTER);
 
   display.update();
 }
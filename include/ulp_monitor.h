@@ -0,0 +1,257 @@
+#ifndef ULP_MONITOR_H
+#define ULP_MONITOR_H
+
+#include "battery.h"
+#include "config.h"
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <driver/rtc_io.h>
+#include <esp32/ulp.h>
+#include <esp_sleep.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/rtc_io_reg.h>
+
+// ULP coprocessor program that watches the button and the battery while the
+// main cores are in deep sleep. It debounces the button and recognises
+// short, long and double presses, samples the battery ADC, and only wakes
+// the SoC for a gesture or when the battery leaves the allowed range.
+// The timer wakeup keeps working as before.
+
+// Button gestures reported by the ULP
+enum ButtonGesture : uint8_t {
+  BUTTON_NONE = 0,
+  BUTTON_SHORT,  // Same as the old button wake: refresh and check remote
+  BUTTON_LONG,   // Force a full refresh of everything
+  BUTTON_DOUBLE  // Toggle (pause/resume) remote mode
+};
+
+// Why the ULP woke the SoC
+#define ULP_WAKE_BUTTON 1
+#define ULP_WAKE_BATTERY 2
+
+// Shared variables in RTC slow memory (word offsets). They live in the
+// ULP reserved area after the program (CONFIG_ULP_COPROC_RESERVE_MEM).
+#define ULP_VAR_BASE 100
+#define ULP_VAR_BATT_DIV 0      // Ticks since last battery sample
+#define ULP_VAR_BATT_LAST 1     // Last raw battery reading
+#define ULP_VAR_BATT_LOW 2      // Wake below this raw value
+#define ULP_VAR_BATT_HIGH 3     // Wake above this raw value
+#define ULP_VAR_PRESS_TICKS 4   // Ticks the button has been held
+#define ULP_VAR_RELEASE_TICKS 5 // Ticks since a short press was released
+#define ULP_VAR_SHORT_PENDING 6 // Short press waiting for a second one
+#define ULP_VAR_GESTURE 7       // ButtonGesture result
+#define ULP_VAR_WAKE_REASON 8   // ULP_WAKE_* value
+#define ULP_VAR_COUNT 9
+
+#define ULP_TICKS(ms) ((ms) / ULP_PERIOD_MS)
+
+// Labels for the ULP program
+enum {
+  ULP_LBL_BUTTON = 1,
+  ULP_LBL_BATT_WAKE,
+  ULP_LBL_RELEASED,
+  ULP_LBL_DOUBLE,
+  ULP_LBL_PENDING,
+  ULP_LBL_GESTURE_WAKE,
+  ULP_LBL_WAKE,
+  ULP_LBL_DONE
+};
+
+inline uint16_t ulpVar(int var) {
+  return RTC_SLOW_MEM[ULP_VAR_BASE + var] & 0xFFFF;
+}
+
+inline void setUlpVar(int var, uint16_t value) {
+  RTC_SLOW_MEM[ULP_VAR_BASE + var] = value;
+}
+
+// Raw ADC value for a battery voltage (inverse of getBatteryVoltage())
+inline uint16_t batteryRawForVoltage(float voltage) {
+  float raw = voltage / 2 / 3.3 * 4095;
+  return constrain((int)raw, 0, 4095);
+}
+
+inline uint16_t batteryRawForPercent(int percentage) {
+  return batteryRawForVoltage(BATTERY_MIN_V + (BATTERY_MAX_V - BATTERY_MIN_V) *
+                                                  percentage / 100.0);
+}
+
+// Gesture that woke us (BUTTON_NONE if the ULP did not wake us for one)
+inline ButtonGesture getUlpGesture() {
+  if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_ULP ||
+      ulpVar(ULP_VAR_WAKE_REASON) != ULP_WAKE_BUTTON) {
+    return BUTTON_NONE;
+  }
+  return (ButtonGesture)ulpVar(ULP_VAR_GESTURE);
+}
+
+// True if the ULP woke us because the battery left its range
+inline bool isUlpBatteryWakeup() {
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_ULP &&
+         ulpVar(ULP_VAR_WAKE_REASON) == ULP_WAKE_BATTERY;
+}
+
+// Stop the ULP timer and give the button back to the digital GPIO matrix.
+// Call early after wake, once the gesture has been read.
+inline void stopUlpMonitor() {
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED)
+    return; // Power-on: ULP never started
+  CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+  rtc_gpio_deinit((gpio_num_t)BUTTON_PIN);
+}
+
+// Load and start the ULP program just before deep sleep, after the
+// configureSleep*() call (EXT0 stays as fallback if loading fails).
+// The battery window is the range that keeps the current power state.
+inline bool startUlpMonitor(PowerState state) {
+  const int adcChannel = digitalPinToAnalogChannel(BATTERY_PIN);
+  const int buttonIo = rtc_io_number_get((gpio_num_t)BUTTON_PIN);
+
+  const ulp_insn_t program[] = {
+      I_MOVI(R3, ULP_VAR_BASE),
+
+      // ---- Battery: sample every ULP_BATTERY_SAMPLE_MS
+      I_LD(R0, R3, ULP_VAR_BATT_DIV),
+      I_ADDI(R0, R0, 1),
+      I_ST(R0, R3, ULP_VAR_BATT_DIV),
+      M_BL(ULP_LBL_BUTTON, ULP_TICKS(ULP_BATTERY_SAMPLE_MS)),
+      I_MOVI(R0, 0),
+      I_ST(R0, R3, ULP_VAR_BATT_DIV),
+      I_ADC(R1, 0, adcChannel),
+      I_ST(R1, R3, ULP_VAR_BATT_LAST),
+      I_LD(R2, R3, ULP_VAR_BATT_LOW),
+      I_SUBR(R0, R1, R2), // Overflow if reading < low
+      M_BXF(ULP_LBL_BATT_WAKE),
+      I_LD(R2, R3, ULP_VAR_BATT_HIGH),
+      I_SUBR(R0, R2, R1), // Overflow if reading > high
+      M_BXF(ULP_LBL_BATT_WAKE),
+      M_BX(ULP_LBL_BUTTON),
+
+      M_LABEL(ULP_LBL_BATT_WAKE),
+      I_MOVI(R0, ULP_WAKE_BATTERY),
+      I_ST(R0, R3, ULP_VAR_WAKE_REASON),
+      M_BX(ULP_LBL_WAKE),
+
+      // ---- Button (active low)
+      M_LABEL(ULP_LBL_BUTTON),
+      I_RD_REG(RTC_GPIO_IN_REG, RTC_GPIO_IN_NEXT_S + buttonIo,
+               RTC_GPIO_IN_NEXT_S + buttonIo),
+      M_BGE(ULP_LBL_RELEASED, 1),
+
+      // Held: count, report a long press once when the limit is reached
+      I_LD(R0, R3, ULP_VAR_PRESS_TICKS),
+      M_BGE(ULP_LBL_DONE, ULP_TICKS(ULP_LONG_PRESS_MS) + 1),
+      I_ADDI(R0, R0, 1),
+      I_ST(R0, R3, ULP_VAR_PRESS_TICKS),
+      M_BL(ULP_LBL_DONE, ULP_TICKS(ULP_LONG_PRESS_MS)),
+      I_MOVI(R0, 0),
+      I_ST(R0, R3, ULP_VAR_SHORT_PENDING),
+      I_MOVI(R0, BUTTON_LONG),
+      I_ST(R0, R3, ULP_VAR_GESTURE),
+      M_BX(ULP_LBL_GESTURE_WAKE),
+
+      // Released: classify the press that just ended
+      M_LABEL(ULP_LBL_RELEASED),
+      I_LD(R1, R3, ULP_VAR_PRESS_TICKS),
+      I_MOVI(R0, 0),
+      I_ST(R0, R3, ULP_VAR_PRESS_TICKS),
+      I_MOVR(R0, R1),
+      M_BL(ULP_LBL_PENDING, ULP_TICKS(ULP_DEBOUNCE_MS)), // No press/bounce
+      M_BGE(ULP_LBL_PENDING, ULP_TICKS(ULP_LONG_PRESS_MS)), // Reported
+      I_LD(R0, R3, ULP_VAR_SHORT_PENDING),
+      M_BGE(ULP_LBL_DOUBLE, 1),
+      I_MOVI(R0, 1),
+      I_ST(R0, R3, ULP_VAR_SHORT_PENDING),
+      I_MOVI(R0, 0),
+      I_ST(R0, R3, ULP_VAR_RELEASE_TICKS),
+      M_BX(ULP_LBL_DONE),
+
+      M_LABEL(ULP_LBL_DOUBLE),
+      I_MOVI(R0, 0),
+      I_ST(R0, R3, ULP_VAR_SHORT_PENDING),
+      I_MOVI(R0, BUTTON_DOUBLE),
+      I_ST(R0, R3, ULP_VAR_GESTURE),
+      M_BX(ULP_LBL_GESTURE_WAKE),
+
+      // A short press becomes final when no second press follows
+      M_LABEL(ULP_LBL_PENDING),
+      I_LD(R0, R3, ULP_VAR_SHORT_PENDING),
+      M_BL(ULP_LBL_DONE, 1),
+      I_LD(R0, R3, ULP_VAR_RELEASE_TICKS),
+      I_ADDI(R0, R0, 1),
+      I_ST(R0, R3, ULP_VAR_RELEASE_TICKS),
+      M_BL(ULP_LBL_DONE, ULP_TICKS(ULP_DOUBLE_PRESS_MS)),
+      I_MOVI(R0, 0),
+      I_ST(R0, R3, ULP_VAR_SHORT_PENDING),
+      I_MOVI(R0, BUTTON_SHORT),
+      I_ST(R0, R3, ULP_VAR_GESTURE),
+
+      M_LABEL(ULP_LBL_GESTURE_WAKE),
+      I_MOVI(R0, ULP_WAKE_BUTTON),
+      I_ST(R0, R3, ULP_VAR_WAKE_REASON),
+
+      M_LABEL(ULP_LBL_WAKE),
+      I_WAKE(),
+      I_END(), // Stop the ULP timer until the next deep sleep
+      I_HALT(),
+
+      M_LABEL(ULP_LBL_DONE),
+      I_HALT(),
+  };
+
+  // Battery window for the current power state
+  uint16_t low = 0;
+  uint16_t high = 4095;
+  switch (state) {
+  case POWER_NORMAL:
+    low = batteryRawForPercent(BATTERY_REDUCED_PCT);
+    break;
+  case POWER_REDUCED:
+    low = batteryRawForPercent(BATTERY_CRITICAL_PCT);
+    high = batteryRawForPercent(BATTERY_REDUCED_PCT + BATTERY_HYSTERESIS_PCT);
+    break;
+  case POWER_CRITICAL:
+    // Only charging brings us back
+    high = batteryRawForVoltage(BATTERY_MAX_V + 0.1);
+    break;
+  }
+
+  for (int i = 0; i < ULP_VAR_COUNT; i++) {
+    setUlpVar(i, 0);
+  }
+  setUlpVar(ULP_VAR_BATT_LOW, low);
+  setUlpVar(ULP_VAR_BATT_HIGH, high);
+  if (digitalRead(BUTTON_PIN) == LOW) {
+    // Still held from this wake: don't report it again
+    setUlpVar(ULP_VAR_PRESS_TICKS, ULP_TICKS(ULP_LONG_PRESS_MS) + 1);
+  }
+
+  size_t size = sizeof(program) / sizeof(ulp_insn_t);
+  if (ulp_process_macros_and_load(0, program, &size) != ESP_OK ||
+      size > ULP_VAR_BASE) {
+    Serial.printf("ULP: program load failed (%d words)\n", (int)size);
+    return false;
+  }
+
+  // Button as RTC input, battery ADC handed to the ULP
+  rtc_gpio_init((gpio_num_t)BUTTON_PIN);
+  rtc_gpio_set_direction((gpio_num_t)BUTTON_PIN, RTC_GPIO_MODE_INPUT_ONLY);
+  adc1_config_width(ADC_WIDTH_BIT_12);
+  adc1_config_channel_atten((adc1_channel_t)adcChannel, ADC_ATTEN_DB_11);
+  adc1_ulp_enable();
+
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+  ulp_set_wakeup_period(0, ULP_PERIOD_MS * 1000);
+  if (ulp_run(0) != ESP_OK) {
+    Serial.println("ULP: start failed");
+    return false;
+  }
+  esp_sleep_enable_ulp_wakeup();
+  // The ULP reports gestures, so a raw level wake is no longer wanted
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_EXT0);
+
+  Serial.printf("ULP monitor running (battery raw %d..%d)\n", low, high);
+  return true;
+}
+
+#endif // ULP_MONITOR_H
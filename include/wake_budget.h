@@ -0,0 +1,211 @@
+#ifndef WAKE_BUDGET_H
+#define WAKE_BUDGET_H
+
+#include "config.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Per-wake active-time budget and the queue of deferred work.
+//
+// Network work is queued (in RTC memory) when it becomes due and drained
+// in priority order after the screen has been drawn. A task only starts
+// when its estimated cost (a running average of its past durations, plus
+// the WiFi connect if the radio is still off) fits in what is left of
+// WAKE_BUDGET_MS; otherwise it waits for a later wake. A task put off
+// WAKE_TASK_MAX_DEFERRALS times runs regardless, so slow work is spread
+// out instead of starved.
+//
+// While the queue is drained a one-shot timer cuts the wake off at
+// WAKE_HARD_LIMIT_MS (a hung server). SD and NVS writes hold it off with
+// a WakeLimitHold: a limit that expires inside one puts the device to
+// sleep from the main task when the write is done. Renders and the
+// telemetry record happen outside the armed window; the panel has its
+// own busy timeout.
+
+// Priority order
+enum WakeTask : uint8_t {
+  TASK_REMOTE_CHECK = 0, // Decides the mode, so it goes first
+  TASK_WEATHER,
+  TASK_TIME_SYNC,
+  TASK_TELEMETRY, // Upload only rides along when the radio is up
+  WAKE_TASK_COUNT
+};
+
+const char *const WAKE_TASK_NAMES[] = {"remote check", "weather",
+                                       "time sync", "telemetry"};
+
+// Estimates before a task has been measured (ms)
+const uint16_t WAKE_TASK_DEFAULT_MS[] = {2000, 2000, 1500, 1000};
+#define WAKE_WIFI_DEFAULT_MS 2500
+
+// RTC-compatible queue state
+struct WakeTaskQueue {
+  uint8_t pending;                         // 1 << WakeTask
+  uint8_t running;                         // Task in progress, or COUNT
+  bool overran;                            // Last wake hit the hard limit
+  uint8_t deferrals[WAKE_TASK_COUNT];      // Wakes put off in a row
+  uint16_t costMs[WAKE_TASK_COUNT];        // Running estimate (0 = none)
+  uint16_t wifiMs;                         // WiFi connect estimate
+};
+
+static WakeTaskQueue *wakeLimitQueue = nullptr;
+static esp_timer_handle_t wakeLimitTimer = nullptr;
+static void (*wakeLimitSleep)() = nullptr; // Normal sleep setup, no return
+static portMUX_TYPE wakeLimitMux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t wakeLimitHolds = 0;    // Writes in progress
+static bool wakeLimitExpired = false; // Timer fired during a write
+static bool wakeLimitSleeping = false;
+
+inline uint16_t blendCost(uint16_t estimate, uint32_t elapsedMs) {
+  elapsedMs = min(elapsedMs, (uint32_t)0xFFFF);
+  return estimate == 0 ? elapsedMs : (3UL * estimate + elapsedMs) / 4;
+}
+
+// The wake took too long: stop it. The task in progress stays queued and
+// is charged the whole budget, so it is put off (rather than retried at
+// once) on the next wakes.
+inline void sleepAfterWakeLimit() {
+  Serial.printf("Wake budget: hard limit (%d ms) hit, forcing sleep\n",
+                WAKE_HARD_LIMIT_MS);
+  if (wakeLimitQueue) {
+    WakeTaskQueue &queue = *wakeLimitQueue;
+    queue.overran = true;
+    if (queue.running < WAKE_TASK_COUNT) {
+      queue.costMs[queue.running] = WAKE_BUDGET_MS;
+    }
+  }
+  wakeLimitSleep();
+}
+
+// Runs in the esp_timer task. Sleeps from here unless a write is in
+// progress, in which case the write's release does it.
+inline void onWakeLimit(void *) {
+  portENTER_CRITICAL(&wakeLimitMux);
+  bool held = wakeLimitHolds > 0;
+  wakeLimitExpired = true;
+  wakeLimitSleeping = !held;
+  portEXIT_CRITICAL(&wakeLimitMux);
+  if (!held) {
+    sleepAfterWakeLimit();
+  }
+}
+
+// Start this wake's accounting. Returns true if the previous wake was cut
+// off by the hard limit.
+inline bool startWakeBudget(WakeTaskQueue &queue) {
+  bool overran = queue.overran;
+  queue.overran = false;
+  queue.running = WAKE_TASK_COUNT;
+  wakeLimitQueue = &queue;
+  return overran;
+}
+
+// Arm the hard limit (counted from the start of the wake) around the
+// network work. sleep: configures the usual wake sources (timer, button,
+// ULP) for WAKE_OVERRUN_SLEEP_SEC and enters deep sleep.
+inline void armWakeLimit(void (*sleep)()) {
+  wakeLimitSleep = sleep;
+  if (!wakeLimitTimer) {
+    esp_timer_create_args_t args = {};
+    args.callback = onWakeLimit;
+    args.name = "wake_limit";
+    if (esp_timer_create(&args, &wakeLimitTimer) != ESP_OK) {
+      Serial.println("Wake budget: no timer, hard limit disabled");
+      return;
+    }
+  }
+  uint32_t elapsed = millis();
+  uint32_t left =
+      elapsed < WAKE_HARD_LIMIT_MS ? WAKE_HARD_LIMIT_MS - elapsed : 1;
+  esp_timer_start_once(wakeLimitTimer, left * 1000ULL);
+}
+
+// Lift the hard limit once the network work is over
+inline void stopWakeBudget() {
+  if (wakeLimitTimer) {
+    esp_timer_stop(wakeLimitTimer);
+  }
+}
+
+// Keeps the hard limit from cutting a write short (SD file, NVS). Nests.
+class WakeLimitHold {
+public:
+  WakeLimitHold() {
+    portENTER_CRITICAL(&wakeLimitMux);
+    bool sleeping = wakeLimitSleeping;
+    if (!sleeping)
+      wakeLimitHolds++;
+    portEXIT_CRITICAL(&wakeLimitMux);
+    while (sleeping) {
+      delay(1000); // The timer task is already putting us to sleep
+    }
+  }
+
+  ~WakeLimitHold() {
+    portENTER_CRITICAL(&wakeLimitMux);
+    bool expired = --wakeLimitHolds == 0 && wakeLimitExpired;
+    if (expired)
+      wakeLimitSleeping = true;
+    portEXIT_CRITICAL(&wakeLimitMux);
+    if (expired) {
+      stopWakeBudget();
+      sleepAfterWakeLimit();
+    }
+  }
+
+  WakeLimitHold(const WakeLimitHold &) = delete;
+  WakeLimitHold &operator=(const WakeLimitHold &) = delete;
+};
+
+inline void queueTask(WakeTaskQueue &queue, WakeTask task) {
+  queue.pending |= 1 << task;
+}
+
+inline bool taskQueued(const WakeTaskQueue &queue, WakeTask task) {
+  return queue.pending & (1 << task);
+}
+
+// Whether a queued task may start now. radioUp: WiFi already connected.
+inline bool taskFits(const WakeTaskQueue &queue, WakeTask task,
+                     bool radioUp) {
+  if (queue.deferrals[task] >= WAKE_TASK_MAX_DEFERRALS)
+    return true;
+  uint32_t cost = queue.costMs[task] ? queue.costMs[task]
+                                     : WAKE_TASK_DEFAULT_MS[task];
+  if (!radioUp)
+    cost += queue.wifiMs ? queue.wifiMs : WAKE_WIFI_DEFAULT_MS;
+  return millis() + cost + WAKE_RENDER_RESERVE_MS <= WAKE_BUDGET_MS;
+}
+
+// Leave a task queued for a later wake
+inline void deferTask(WakeTaskQueue &queue, WakeTask task) {
+  if (queue.deferrals[task] < 0xFF)
+    queue.deferrals[task]++;
+  Serial.printf("Wake budget: %s deferred (%lu ms used, %u in a row)\n",
+                WAKE_TASK_NAMES[task], millis(), queue.deferrals[task]);
+}
+
+inline void beginTask(WakeTaskQueue &queue, WakeTask task) {
+  queue.running = task;
+}
+
+// Task done (successfully or not): dequeue it and learn its cost
+inline void finishTask(WakeTaskQueue &queue, WakeTask task,
+                       uint32_t elapsedMs) {
+  queue.pending &= ~(1 << task);
+  queue.running = WAKE_TASK_COUNT;
+  queue.deferrals[task] = 0;
+  queue.costMs[task] = blendCost(queue.costMs[task], elapsedMs);
+}
+
+// Dequeue a task that no longer applies, without running it
+inline void dropTask(WakeTaskQueue &queue, WakeTask task) {
+  queue.pending &= ~(1 << task);
+  queue.deferrals[task] = 0;
+}
+
+inline void recordWifiCost(WakeTaskQueue &queue, uint32_t elapsedMs) {
+  queue.wifiMs = blendCost(queue.wifiMs, elapsedMs);
+}
+
+#endif // WAKE_BUDGET_H
@@ -2,95 +2,105 @@
 #define WEATHER_H
 
 #include "config.h"
+#include "dns_cache.h"
+#include "energy_model.h"
+#include "forecast_parser.h"
+#include "json_arena.h"
+#include "power_profile.h"
+#include "runtime_config.h"
+#include "tls_client.h"
+#include "weather_data.h"
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 #include <WiFi.h>
 
-// RTC-compatible struct (no dynamic allocation)
-// Can be stored in RTC memory to persist across deep sleep
-struct WeatherData {
-  float temperature;
-  float feelsLike;
-  int humidity;
-  char condition[16];      // Fixed size for RTC memory
-  char icon[64];           // Fixed size for RTC memory
-  bool isDay;
-  bool valid;
-  // Forecast data
-  int chanceOfRain;        // % chance of rain today
-  float maxTemp;
-  float minTemp;
-  char forecastCondition[16];
-};
+#define WEATHER_URL_MAX 256
+
+// Parse memory for forecast.json (see json_arena.h)
+static uint8_t weatherArenaBuffer[WEATHER_ARENA_SIZE] __attribute__((aligned(8)));
 
 class WeatherClient {
 private:
   WeatherData currentWeather;
   unsigned long lastUpdate;
-
-  String buildUrl() {
-    return String("http://api.weatherapi.com/v1/forecast.json?key=") +
-           WEATHER_API_KEY + "&q=" + WEATHER_LOCATION + "&days=1&lang=pt";
+  long validForSec; // From Cache-Control max-age (-1 = no hint)
+  char serverDate[40]; // HTTP Date header of the last response
+  JsonArena arena;
+
+  bool buildUrl(const RuntimeConfig &config, char *url, size_t size) {
+    int n = snprintf(url, size, "%s?key=%s&q=%s&days=1&lang=pt",
+                     config.weatherApiUrl, WEATHER_API_KEY, config.location);
+    return n > 0 && (size_t)n < size;
   }
 
 public:
-  WeatherClient() : lastUpdate(0) { currentWeather.valid = false; }
+  WeatherClient()
+      : lastUpdate(0), validForSec(-1),
+        arena(weatherArenaBuffer, sizeof(weatherArenaBuffer)) {
+    currentWeather.valid = false;
+    serverDate[0] = '\0';
+  }
 
-  bool fetchWeather() {
+  // Fill currentWeather from a forecast.json response (body text or the
+  // HTTP stream); see forecast_parser.h
+  template <typename TInput> bool parseWeather(TInput &&payload) {
+    if (!parseForecast(payload, arena, currentWeather))
+      return false;
+    lastUpdate = millis();
+    return true;
+  }
+
+  bool fetchWeather(const RuntimeConfig &config, DnsCache &dns,
+                    TlsSessionCache &tls) {
     if (WiFi.status() != WL_CONNECTED) {
       Serial.println("WiFi not connected, skipping weather update");
       return false;
     }
 
-    if (String(WEATHER_API_KEY) == "YOUR_API_KEY_HERE") {
+    if (strcmp(WEATHER_API_KEY, "YOUR_API_KEY_HERE") == 0) {
       Serial.println("Weather API key not configured");
       currentWeather.valid = false;
       return false;
     }
 
+    char url[WEATHER_URL_MAX];
+    if (!buildUrl(config, url, sizeof(url))) {
+      Serial.println("Weather URL too long");
+      return false;
+    }
+    WiFiClient plainClient;
+    ResumableTlsClient tlsClient(url, tls);
+    WiFiClient &client = isHttpsUrl(url) ? tlsClient : plainClient;
     HTTPClient http;
-    String url = buildUrl();
 
     Serial.println("Fetching weather from WeatherAPI...");
-    http.begin(url);
+    setPowerPhase(PHASE_NETWORK);
+    bool connected = beginCached(http, client, url, dns);
+    http.useHTTP10(true); // No chunked encoding, so the body can be streamed
 
-    int httpCode = http.GET();
+    // Freshness hint and server time from the API
+    const char *headerKeys[] = {"Cache-Control", "Date"};
+    http.collectHeaders(headerKeys, 2);
+    validForSec = -1;
 
-    if (httpCode == HTTP_CODE_OK) {
-      String payload = http.getString();
-      JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, payload);
-
-      if (!error) {
-        // Current weather
-        currentWeather.temperature = doc["current"]["temp_c"];
-        currentWeather.feelsLike = doc["current"]["feelslike_c"];
-        currentWeather.humidity = doc["current"]["humidity"];
-
-        // Copy strings to fixed-size buffers
-        const char* condText = doc["current"]["condition"]["text"];
-        strncpy(currentWeather.condition, condText ? condText : "", sizeof(currentWeather.condition) - 1);
-        currentWeather.condition[sizeof(currentWeather.condition) - 1] = '\0';
-
-        const char* iconText = doc["current"]["condition"]["icon"];
-        strncpy(currentWeather.icon, iconText ? iconText : "", sizeof(currentWeather.icon) - 1);
-        currentWeather.icon[sizeof(currentWeather.icon) - 1] = '\0';
-
-        currentWeather.isDay = doc["current"]["is_day"] == 1;
+    if (connected)
+      countHttpRequest();
+    int httpCode = connected ? http.GET() : HTTPC_ERROR_CONNECTION_REFUSED;
+    copyHttpHeader(http, "Date", serverDate, sizeof(serverDate));
 
-        // Forecast data for today
-        JsonObject forecastDay = doc["forecast"]["forecastday"][0]["day"];
-        currentWeather.chanceOfRain = forecastDay["daily_chance_of_rain"];
-        currentWeather.maxTemp = forecastDay["maxtemp_c"];
-        currentWeather.minTemp = forecastDay["mintemp_c"];
-
-        const char* forecastText = forecastDay["condition"]["text"];
-        strncpy(currentWeather.forecastCondition, forecastText ? forecastText : "", sizeof(currentWeather.forecastCondition) - 1);
-        currentWeather.forecastCondition[sizeof(currentWeather.forecastCondition) - 1] = '\0';
-
-        currentWeather.valid = true;
-        lastUpdate = millis();
+    if (httpCode == HTTP_CODE_OK) {
+      // Parsed straight from the socket; no copy of the body is kept
+      bool parsed = parseWeather(http.getStream());
+      setPowerPhase(PHASE_COMPUTE);
+      if (parsed) {
+        char cacheControl[64];
+        copyHttpHeader(http, "Cache-Control", cacheControl,
+                       sizeof(cacheControl));
+        const char *maxAge = strstr(cacheControl, "max-age=");
+        if (maxAge) {
+          validForSec = atol(maxAge + 8);
+        }
 
         Serial.printf(
             "Weather: %.1f°C, %s, Chuva: %d%%\n", currentWeather.temperature,
@@ -106,11 +116,12 @@ public:
     }
 
     http.end();
+    setPowerPhase(PHASE_COMPUTE);
     currentWeather.valid = false;
     return false;
   }
 
-  WeatherData getWeather() { return currentWeather; }
+  const WeatherData &getWeather() const { return currentWeather; }
 
   // Get pointer to weather data (for RTC memory storage)
   WeatherData* getWeatherPtr() { return &currentWeather; }
@@ -120,69 +131,45 @@ public:
 
   bool isValid() { return currentWeather.valid; }
 
+  // HTTP Date header of the last response (empty if none)
+  const char *getServerDate() { return serverDate; }
+
+  // Seconds the last fetched data stays fresh per the API (-1 = no hint)
+  long getValidForSec() { return validForSec; }
+
   bool needsUpdate() {
     // With deep sleep, we track updates differently using RTC memory
     // This function is kept for compatibility but not used
     return (millis() - lastUpdate) > (WEATHER_UPDATE_MIN * 60000UL);
   }
 
-  String getTemperatureString() {
-    if (!currentWeather.valid)
-      return "--°C";
-    char buf[10];
-    snprintf(buf, sizeof(buf), "%.0f°C", currentWeather.temperature);
-    return String(buf);
+  // Formatters write into a caller buffer and return it
+  const char *getTemperatureString(char *buf, size_t size) {
+    return formatTemperature(currentWeather, buf, size);
   }
 
-  String getHumidityString() {
-    if (!currentWeather.valid)
-      return "--%";
-    char buf[10];
-    snprintf(buf, sizeof(buf), "%d%%", currentWeather.humidity);
-    return String(buf);
-  }
-
-  String getDaySuggestion() {
-    if (!currentWeather.valid)
-      return "";
-
-    // Rain takes priority
-    if (currentWeather.chanceOfRain >= 70) {
-      return "Leva guarda-chuva!!!";
-    }
-    if (currentWeather.chanceOfRain >= 40) {
-      return "Cuidado, pode chover";
-    }
-
-    // Cold weather check
-    if (currentWeather.temperature <= 10 || currentWeather.minTemp <= 8) {
-      return "Frio pa porra, momoti!";
-    }
-    if (currentWeather.temperature <= 15 || currentWeather.minTemp <= 12) {
-      return "Leve um casaquinho";
-    }
-
-    // Hot weather
-    if (currentWeather.maxTemp >= 30) {
-      return "Socorro, que calor!";
-    }
-
-    // Nice day - no rain, pleasant temperature
-    if (currentWeather.chanceOfRain < 20 && currentWeather.maxTemp >= 18 &&
-        currentWeather.maxTemp <= 28) {
-      return "O dia lindo, igual voce";
+  const char *getHumidityString(char *buf, size_t size) {
+    if (!currentWeather.valid) {
+      snprintf(buf, size, "--%%");
+    } else {
+      snprintf(buf, size, "%d%%", currentWeather.humidity);
     }
+    return buf;
+  }
 
-    return "GOSTOSA!";
+  // Index into DAY_SUGGESTIONS for the current weather
+  uint8_t getDaySuggestionIndex() {
+    return daySuggestionIndex(currentWeather);
   }
 
-  String getMinMaxString() {
+  const char *getDaySuggestion() {
     if (!currentWeather.valid)
       return "";
-    char buf[20];
-    snprintf(buf, sizeof(buf), "%.0f° / %.0f°", currentWeather.minTemp,
-             currentWeather.maxTemp);
-    return String(buf);
+    return DAY_SUGGESTIONS[getDaySuggestionIndex()];
+  }
+
+  const char *getMinMaxString(char *buf, size_t size) {
+    return formatMinMax(currentWeather, buf, size);
   }
 
   int getChanceOfRain() {
@@ -0,0 +1,90 @@
+#ifndef WEATHER_DATA_H
+#define WEATHER_DATA_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Weather as shown on screen, and the formatting and suggestion rules
+// built on it. Kept apart from the fetch code (weather.h) so the drawing
+// code does not pull in WiFi and HTTP.
+
+// RTC-compatible struct (no dynamic allocation)
+// Can be stored in RTC memory to persist across deep sleep
+struct WeatherData {
+  float temperature;
+  float feelsLike;
+  int humidity;
+  char condition[16];      // Fixed size for RTC memory
+  char icon[64];           // Fixed size for RTC memory
+  bool isDay;
+  bool valid;
+  // Forecast data
+  int chanceOfRain;        // % chance of rain today
+  float maxTemp;
+  float minTemp;
+  char forecastCondition[16];
+};
+
+// Day suggestions, picked from the forecast
+enum DaySuggestion : uint8_t {
+  SUGGESTION_UMBRELLA = 0,
+  SUGGESTION_MAYBE_RAIN,
+  SUGGESTION_COLD,
+  SUGGESTION_COOL,
+  SUGGESTION_HOT,
+  SUGGESTION_NICE,
+  SUGGESTION_DEFAULT
+};
+
+const char *const DAY_SUGGESTIONS[] = {
+    "Leva guarda-chuva!!!",   "Cuidado, pode chover", "Frio pa porra, momoti!",
+    "Leve um casaquinho",     "Socorro, que calor!",  "O dia lindo, igual voce",
+    "GOSTOSA!"};
+
+// Index into DAY_SUGGESTIONS for this weather
+inline uint8_t daySuggestionIndex(const WeatherData &w) {
+  // Rain takes priority
+  if (w.chanceOfRain >= 70)
+    return SUGGESTION_UMBRELLA;
+  if (w.chanceOfRain >= 40)
+    return SUGGESTION_MAYBE_RAIN;
+
+  // Cold weather check
+  if (w.temperature <= 10 || w.minTemp <= 8)
+    return SUGGESTION_COLD;
+  if (w.temperature <= 15 || w.minTemp <= 12)
+    return SUGGESTION_COOL;
+
+  // Hot weather
+  if (w.maxTemp >= 30)
+    return SUGGESTION_HOT;
+
+  // Nice day - no rain, pleasant temperature
+  if (w.chanceOfRain < 20 && w.maxTemp >= 18 && w.maxTemp <= 28)
+    return SUGGESTION_NICE;
+
+  return SUGGESTION_DEFAULT;
+}
+
+// Formatters write into a caller buffer and return it
+inline const char *formatTemperature(const WeatherData &w, char *buf,
+                                     size_t size) {
+  if (!w.valid) {
+    snprintf(buf, size, "--°C");
+  } else {
+    snprintf(buf, size, "%.0f°C", w.temperature);
+  }
+  return buf;
+}
+
+inline const char *formatMinMax(const WeatherData &w, char *buf,
+                                size_t size) {
+  if (!w.valid) {
+    buf[0] = '\0';
+  } else {
+    snprintf(buf, size, "%.0f° / %.0f°", w.minTemp, w.maxTemp);
+  }
+  return buf;
+}
+
+#endif // WEATHER_DATA_H
@@ -0,0 +1,56 @@
+#ifndef WEATHER_VIEW_H
+#define WEATHER_VIEW_H
+
+#include "canvas.h"
+#include "icons.h"
+#include "layout.h"
+#include "weather_data.h"
+
+// Ready-to-draw weather, built once per fetch and kept in RTC memory.
+// Icon lookup, the suggestion cascade, number formatting and the message
+// font choice only run when the weather changes; ordinary wakes copy the
+// strings straight onto the screen.
+struct WeatherView {
+  bool valid;
+  uint8_t icon;        // WeatherIconType
+  uint8_t suggestion;  // DaySuggestion
+  bool suggestionLong; // Suggestion needs the message widget's longFont
+  char temperature[8]; // "-12°C"
+  char minMax[16];     // "-12° / -3°"
+  char condition[11];  // First 10 chars of the condition
+  char rain[12];       // "Chuva: 100%"
+};
+
+// Layout entry for a source (nullptr if this layout does not show it)
+inline const WidgetLayout *findWidget(WidgetSource source) {
+  for (size_t i = 0; i < MAIN_WIDGET_COUNT; i++) {
+    if (MAIN_LAYOUT[i].source == source)
+      return &MAIN_LAYOUT[i];
+  }
+  return nullptr;
+}
+
+// Rebuild the view from freshly fetched (or restored) weather
+inline void buildWeatherView(Canvas &display, const WeatherData &w,
+                             WeatherView &view) {
+  memset(&view, 0, sizeof(view));
+  if (!w.valid)
+    return;
+
+  view.icon = getWeatherIconType(w.condition, w.isDay);
+  view.suggestion = daySuggestionIndex(w);
+  formatTemperature(w, view.temperature, sizeof(view.temperature));
+  formatMinMax(w, view.minMax, sizeof(view.minMax));
+  strncpy(view.condition, w.condition, sizeof(view.condition) - 1);
+  snprintf(view.rain, sizeof(view.rain), "Chuva: %d%%", w.chanceOfRain);
+
+  const WidgetLayout *message = findWidget(SOURCE_MESSAGE);
+  if (message && message->longFont) {
+    display.setFont(message->font);
+    view.suggestionLong = display.textWidth(DAY_SUGGESTIONS[view.suggestion]) >
+                          message->bounds.w;
+  }
+  view.valid = true;
+}
+
+#endif // WEATHER_VIEW_H
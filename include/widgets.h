@@ -0,0 +1,165 @@
+#ifndef WIDGETS_H
+#define WIDGETS_H
+
+#include "canvas.h"
+#include "config.h"
+#include "icons.h"
+#include "layout.h"
+#include "messages.h"
+#include "time_manager.h"
+#include "weather_data.h"
+#include "weather_view.h"
+
+// Main screen widgets drawn into a Canvas: no panel, battery or network,
+// so the same code runs on the device and in the host frame renderer.
+
+// Everything the main screen shows, gathered once per draw
+struct ScreenData {
+  const WeatherView *view;
+  const char *message;  // Morning message or day suggestion
+  bool morningMessage;  // Font not precomputed, measured when drawn
+  const unsigned char *batteryIcon;
+  bool wifiConnected; // Last connect attempt succeeded
+};
+
+// wifiOnline: outcome of the last WiFi connect; batteryIcon: status bar
+// battery (ui.h reads it from the ADC)
+inline ScreenData makeScreenData(const WeatherView &view,
+                                 bool showMorningMessage, bool wifiOnline,
+                                 const unsigned char *batteryIcon) {
+  ScreenData data;
+  data.view = &view;
+  data.message = "";
+  data.morningMessage = false;
+  if (view.valid) {
+    // Toggle between morning message and day suggestion
+    if (isMorning() && showMorningMessage) {
+      data.message = getMorningMessage(getDayOfYear());
+      data.morningMessage = true;
+    } else {
+      data.message = DAY_SUGGESTIONS[view.suggestion];
+    }
+  }
+  data.batteryIcon = batteryIcon;
+  data.wifiConnected = wifiOnline;
+  return data;
+}
+
+// Cheap value that changes whenever the widget would look different
+inline uint32_t widgetKey(WidgetSource source, const ScreenData &data) {
+  const WeatherView *view = data.view;
+  if (!view->valid && source <= SOURCE_MESSAGE)
+    return 0; // Placeholders
+
+  switch (source) {
+  case SOURCE_WEATHER_ICON:
+    return view->icon + 1;
+  case SOURCE_TEMPERATURE:
+    return layoutKey(view->temperature);
+  case SOURCE_CONDITION:
+    return layoutKey(view->condition);
+  case SOURCE_MIN_MAX:
+    return layoutKey(view->minMax);
+  case SOURCE_RAIN:
+    return layoutKey(view->rain);
+  case SOURCE_MESSAGE:
+    return layoutKey(data.message);
+  case SOURCE_TIME:
+    return getMinutesSinceMidnight() + 1000;
+  case SOURCE_DATE:
+    return layoutKey(getDateStr());
+  case SOURCE_STATUS:
+    return (uint32_t)(uintptr_t)data.batteryIcon ^ data.wifiConnected;
+  default:
+    return 1; // Static
+  }
+}
+
+// Status bar (WiFi + Battery), right-aligned in its box
+inline void drawStatusBar(Canvas &display, const WidgetRect &b,
+                          const ScreenData &data) {
+  int x = b.x + b.w - BATTERY_ICON_WIDTH;
+  display.drawBitmap(x, b.y, data.batteryIcon, BATTERY_ICON_WIDTH,
+                     BATTERY_ICON_HEIGHT);
+
+  // Small gap
+  x -= 4 + WIFI_ICON_WIDTH;
+  display.drawBitmap(x, b.y, data.wifiConnected ? icon_wifi : icon_wifi_off,
+                     WIFI_ICON_WIDTH, WIFI_ICON_HEIGHT);
+}
+
+inline void drawWidget(Canvas &display, const WidgetLayout &widget,
+                       const ScreenData &data) {
+  const WidgetRect &b = widget.bounds;
+  const WeatherView *view = data.view;
+  if (widget.font) {
+    display.setFont(widget.font);
+  }
+
+  // No weather data: placeholders only
+  if (!view->valid && widget.source <= SOURCE_MESSAGE) {
+    if (widget.source == SOURCE_WEATHER_ICON) {
+      display.drawRect(b.x, b.y, b.w, b.h);
+    } else if (widget.source == SOURCE_TEMPERATURE) {
+      display.setFont(&FreeSans9pt7b);
+      display.drawTextIn("Clima: --", b.x, b.w, widget.baseline,
+                         widget.align);
+    }
+    return;
+  }
+
+  switch (widget.source) {
+  case SOURCE_WEATHER_ICON:
+    display.drawBitmap(b.x, b.y, WEATHER_ICONS[view->icon], ICON_WIDTH,
+                       ICON_HEIGHT);
+    break;
+  case SOURCE_TEMPERATURE:
+    display.drawTextIn(view->temperature, b.x, b.w, widget.baseline,
+                       widget.align);
+    break;
+  case SOURCE_CONDITION:
+    display.drawTextIn(view->condition, b.x, b.w, widget.baseline,
+                       widget.align);
+    break;
+  case SOURCE_MIN_MAX:
+    display.drawTextIn(view->minMax, b.x, b.w, widget.baseline, widget.align);
+    break;
+  case SOURCE_RAIN:
+    display.drawTextIn(view->rain, b.x, b.w, widget.baseline, widget.align);
+    break;
+  case SOURCE_MESSAGE:
+    if (widget.longFont &&
+        (data.morningMessage ? display.textWidth(data.message) > b.w
+                             : view->suggestionLong)) {
+      display.setFont(widget.longFont);
+    }
+    display.drawTextIn(data.message, b.x, b.w, widget.baseline,
+                       widget.align);
+    break;
+  case SOURCE_SEPARATOR:
+    display.drawLine(b.x, b.y, b.x + b.w, b.y);
+    break;
+  case SOURCE_TIME:
+    display.drawTextIn(getTimeStr(), b.x, b.w, widget.baseline, widget.align);
+    break;
+  case SOURCE_DATE:
+    display.drawTextIn(getDateStr(), b.x, b.w, widget.baseline, widget.align);
+    break;
+  case SOURCE_STATUS:
+    drawStatusBar(display, b, data);
+    break;
+  default:
+    break;
+  }
+}
+
+inline void renderWidgets(Canvas &display, const ScreenData &data,
+                          WidgetMask mask) {
+  for (size_t i = 0; i < MAIN_WIDGET_COUNT; i++) {
+    if (mask & (1 << i)) {
+      drawWidget(display, MAIN_LAYOUT[i], data);
+    }
+  }
+}
+
+#endif // WIDGETS_H
@@ -2,40 +2,212 @@
 #define WIFI_MANAGER_H
 
 #include "config.h"
+#include "power_profile.h"
 #include <WiFi.h>
 
-// Connect to WiFi with timeout
-// Returns true if connected successfully
-inline bool connectWiFi() {
-  if (WiFi.status() == WL_CONNECTED) {
-    return true;
+// Multi-network connect. Every attempt updates small per-network stats in
+// RTC memory (success rate, RSSI, time to connect, channel and BSSID).
+// Networks seen before are tried first, cheapest expected connect first,
+// straight on their cached channel with a short timeout. Only when all of
+// them fail is the air scanned, and then only configured networks that
+// are actually in range are tried, strongest first. A missing AP costs a
+// few seconds instead of the full timeout on every wake.
+
+#define WIFI_MAX_NETWORKS 4
+#define WIFI_STATS_WINDOW 16 // Attempts before the counts are halved
+
+struct WifiCredential {
+  const char *ssid;
+  const char *password;
+};
+
+const WifiCredential WIFI_CREDENTIALS[] = {WIFI_NETWORKS};
+#define WIFI_NETWORK_COUNT                                                     \
+  (sizeof(WIFI_CREDENTIALS) / sizeof(WIFI_CREDENTIALS[0]))
+static_assert(WIFI_NETWORK_COUNT <= WIFI_MAX_NETWORKS,
+              "raise WIFI_MAX_NETWORKS");
+
+// RTC-compatible per-network history (index = position in WIFI_NETWORKS)
+struct WifiNetworkStats {
+  uint8_t attempts;   // Recent attempts (halved every WIFI_STATS_WINDOW)
+  uint8_t successes;  // Of which connected
+  int8_t rssi;        // Last RSSI seen (0 = never)
+  uint8_t channel;    // Last channel (0 = unknown, needs a scan)
+  uint8_t bssid[6];   // Last AP seen for this SSID
+  uint16_t connectMs; // Running average time to connect
+};
+
+struct WifiStats {
+  WifiNetworkStats networks[WIFI_MAX_NETWORKS];
+};
+
+// Expected cost of one cached attempt: time to connect when it works,
+// the fast timeout when it does not
+inline uint32_t wifiExpectedMs(const WifiNetworkStats &net) {
+  if (net.attempts == 0)
+    return WIFI_FAST_TIMEOUT_MS;
+  uint32_t failures = net.attempts - net.successes;
+  return ((uint32_t)net.connectMs * net.successes +
+          (uint32_t)WIFI_FAST_TIMEOUT_MS * failures) /
+         net.attempts;
+}
+
+inline void recordWifiAttempt(WifiNetworkStats &net, bool connected,
+                              uint32_t elapsedMs) {
+  if (net.attempts >= WIFI_STATS_WINDOW) {
+    net.attempts /= 2;
+    net.successes /= 2;
+  }
+  net.attempts++;
+  if (!connected) {
+    net.channel = 0; // Rescan before trusting it again
+    return;
   }
 
-  Serial.printf("Connecting to %s", WIFI_SSID);
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  net.successes++;
+  elapsedMs = min(elapsedMs, (uint32_t)0xFFFF);
+  net.connectMs = net.connectMs ? (3UL * net.connectMs + elapsedMs) / 4
+                                : elapsedMs;
+  net.rssi = WiFi.RSSI();
+  net.channel = WiFi.channel();
+  const uint8_t *bssid = WiFi.BSSID();
+  if (bssid) {
+    memcpy(net.bssid, bssid, sizeof(net.bssid));
+  }
+}
 
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 40) {
-    delay(250);
+// One association attempt. channel 0: let the driver search.
+inline bool tryWifiNetwork(WifiStats &stats, uint8_t index, uint8_t channel,
+                           const uint8_t *bssid, uint32_t timeoutMs) {
+  const WifiCredential &cred = WIFI_CREDENTIALS[index];
+  Serial.printf("Connecting to %s (channel %d)", cred.ssid, channel);
+  uint32_t start = millis();
+  WiFi.begin(cred.ssid, cred.password, channel, channel ? bssid : nullptr);
+  while (WiFi.status() != WL_CONNECTED && millis() - start < timeoutMs) {
+    delay(100);
     Serial.print(".");
-    attempts++;
   }
 
+  bool connected = WiFi.status() == WL_CONNECTED;
+  recordWifiAttempt(stats.networks[index], connected, millis() - start);
+  if (!connected) {
+    Serial.println(" Failed!");
+    WiFi.disconnect();
+    return false;
+  }
+  Serial.printf(" Connected in %lu ms (%d dBm)\n", millis() - start,
+                WiFi.RSSI());
+  return true;
+}
+
+// Networks with a cached channel, cheapest expected connect first
+inline bool tryCachedNetworks(WifiStats &stats) {
+  uint8_t order[WIFI_MAX_NETWORKS];
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < WIFI_NETWORK_COUNT; i++) {
+    if (stats.networks[i].channel == 0)
+      continue;
+    // Insertion sort, ties go to the stronger signal
+    const WifiNetworkStats &net = stats.networks[i];
+    uint32_t ms = wifiExpectedMs(net);
+    uint8_t pos = count++;
+    while (pos > 0) {
+      const WifiNetworkStats &prev = stats.networks[order[pos - 1]];
+      uint32_t prevMs = wifiExpectedMs(prev);
+      if (prevMs < ms || (prevMs == ms && prev.rssi >= net.rssi))
+        break;
+      order[pos] = order[pos - 1];
+      pos--;
+    }
+    order[pos] = i;
+  }
+
+  for (uint8_t k = 0; k < count; k++) {
+    WifiNetworkStats &net = stats.networks[order[k]];
+    if (tryWifiNetwork(stats, order[k], net.channel, net.bssid,
+                       WIFI_FAST_TIMEOUT_MS))
+      return true;
+  }
+  return false;
+}
+
+// Scan, then try the configured networks in range, strongest first
+inline bool tryScannedNetworks(WifiStats &stats) {
+  Serial.println("WiFi: scanning");
+  int16_t found = WiFi.scanNetworks(false, false, false,
+                                    WIFI_SCAN_MS_PER_CHANNEL);
+  for (uint8_t i = 0; i < WIFI_NETWORK_COUNT; i++) {
+    stats.networks[i].channel = 0;
+    stats.networks[i].rssi = 0;
+  }
+  for (int16_t s = 0; s < found; s++) {
+    // The scan's own record: the SSID accessor would copy it into a String
+    const wifi_ap_record_t *ap =
+        (const wifi_ap_record_t *)WiFi.getScanInfoByIndex(s);
+    if (!ap)
+      continue;
+    for (uint8_t i = 0; i < WIFI_NETWORK_COUNT; i++) {
+      WifiNetworkStats &net = stats.networks[i];
+      // Strongest AP for each SSID
+      if (strcmp((const char *)ap->ssid, WIFI_CREDENTIALS[i].ssid) == 0 &&
+          (net.channel == 0 || ap->rssi > net.rssi)) {
+        net.rssi = ap->rssi;
+        net.channel = ap->primary;
+        memcpy(net.bssid, ap->bssid, sizeof(net.bssid));
+      }
+    }
+  }
+  WiFi.scanDelete();
+
+  while (true) {
+    int best = -1;
+    for (uint8_t i = 0; i < WIFI_NETWORK_COUNT; i++) {
+      if (stats.networks[i].channel != 0 &&
+          (best < 0 || stats.networks[i].rssi > stats.networks[best].rssi))
+        best = i;
+    }
+    if (best < 0) {
+      Serial.println("WiFi: no known network in range");
+      return false;
+    }
+    WifiNetworkStats &net = stats.networks[best];
+    if (tryWifiNetwork(stats, best, net.channel, net.bssid,
+                       WIFI_CONNECT_TIMEOUT_MS))
+      return true;
+    // A failed attempt clears the channel, so the loop moves on
+  }
+}
+
+// Connect to the best known network
+// Returns true if connected successfully
+inline bool connectWiFi(WifiStats &stats) {
   if (WiFi.status() == WL_CONNECTED) {
-    Serial.println(" Connected!");
-    Serial.print("IP: ");
-    Serial.println(WiFi.localIP());
     return true;
   }
 
-  Serial.println(" Failed!");
-  return false;
+  setRadioPower(true);
+  PowerPhase previous = setPowerPhase(PHASE_NETWORK);
+  WiFi.persistent(false); // Credentials come from config.h, not flash
+  WiFi.mode(WIFI_STA);
+  bool connected = tryCachedNetworks(stats) || tryScannedNetworks(stats);
+  setPowerPhase(previous);
+
+  if (connected) {
+#if WIFI_MODEM_SLEEP
+    // Radio dozes between DTIM beacons while we parse and render
+    WiFi.setSleep(WIFI_PS_MIN_MODEM);
+#endif
+    Serial.print("IP: ");
+    Serial.println(WiFi.localIP());
+  }
+  return connected;
 }
 
 // Disconnect WiFi and turn off radio for power saving
 inline void disconnectWiFi() {
   WiFi.disconnect(true);
   WiFi.mode(WIFI_OFF);
+  setRadioPower(false);
 }
 
 // Check if WiFi is connected
@@ -0,0 +1,6 @@
+#ifndef HOST_ADAFRUIT_I2CDEVICE_H
+#define HOST_ADAFRUIT_I2CDEVICE_H
+
+// Included by Adafruit_GFX.h; the host build has no I2C (BusIO ignored)
+
+#endif // HOST_ADAFRUIT_I2CDEVICE_H
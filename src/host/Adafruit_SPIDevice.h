@@ -0,0 +1,6 @@
+#ifndef HOST_ADAFRUIT_SPIDEVICE_H
+#define HOST_ADAFRUIT_SPIDEVICE_H
+
+// Included by Adafruit_GFX.h; the host build has no SPI (BusIO ignored)
+
+#endif // HOST_ADAFRUIT_SPIDEVICE_H
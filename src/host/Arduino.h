@@ -0,0 +1,93 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal Arduino core for building the drawing code on the host
+// ([env:native_render]). Only what include/ needs for frame_renderer.h:
+// no pins, no WiFi, no RTC memory. The wake simulator (HOST_SIM,
+// [env:native_sim]) adds all of those from sim_device.h.
+
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <time.h>
+
+#include "Print.h"
+#include "Stream.h"
+
+using std::max;
+using std::min;
+
+// Flash and RAM are one address space on the host (matches glcdfont.c)
+#define PROGMEM
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#endif
+
+class __FlashStringHelper;
+
+// Enough String for Adafruit_GFX's getTextBounds(const String &) overload
+class String {
+private:
+  const char *text;
+
+public:
+  String(const char *text = "") : text(text ? text : "") {}
+  const char *c_str() const { return text; }
+  unsigned int length() const { return strlen(text); }
+};
+
+// Logs go to stderr; stdout carries the renderer's replies. The
+// simulator drops them unless asked for (nullptr).
+static FILE *hostSerialOut = stderr;
+
+class HostSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  void flush() {}
+  size_t write(uint8_t c) override {
+    if (!hostSerialOut)
+      return 1;
+    return fputc(c, hostSerialOut) == EOF ? 0 : 1;
+  }
+  using Print::write;
+};
+
+static HostSerial Serial;
+
+#ifdef HOST_SIM
+// Virtual clock, pins and the rest of the simulated ESP32
+#include "sim_device.h"
+#else
+inline unsigned long millis() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+inline void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// The host clock is already set
+inline void configTime(long, int, const char *) {}
+
+inline bool getLocalTime(struct tm *info, uint32_t ms = 5000) {
+  (void)ms;
+  time_t now = time(nullptr);
+  return localtime_r(&now, info) != nullptr;
+}
+#endif
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,41 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+
+// File system API for the wake simulator. There is no SD card (SD.h), so
+// no file ever opens.
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File : public Stream {
+public:
+  operator bool() const { return false; }
+  size_t write(uint8_t) override { return 0; }
+  size_t write(const uint8_t *, size_t) override { return 0; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  size_t read(uint8_t *, size_t) { return 0; }
+  int peek() override { return -1; }
+  void close() {}
+};
+
+class FS {
+public:
+  File open(const char *, const char * = FILE_READ, bool = false) {
+    return File();
+  }
+  bool exists(const char *) { return false; }
+  bool remove(const char *) { return false; }
+  bool mkdir(const char *) { return false; }
+};
+
+} // namespace fs
+
+using fs::File;
+
+#endif // HOST_FS_H
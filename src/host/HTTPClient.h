@@ -0,0 +1,135 @@
+#ifndef HOST_HTTPCLIENT_H
+#define HOST_HTTPCLIENT_H
+
+#include "config.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <strings.h>
+
+// HTTPClient for the wake simulator, answered by a mock server instead of
+// the network:
+//   .../forecast.json   200, SimServer::weather (Cache-Control max-age
+//                       when SimServer::maxAge >= 0)
+//   REMOTE_API_URL      200, SimServer::remote
+//   TELEMETRY_URL       200, no body
+//   anything else       404
+// Every response carries the true time in its Date header. A request
+// takes SimSetup::httpMs plus its bytes at SimSetup::httpKbps.
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NO_CONTENT 204
+#define HTTP_CODE_NOT_FOUND 404
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+#define SIM_HTTP_URL_MAX 256
+#define SIM_HTTP_HEADERS 4
+#define SIM_HTTP_OVERHEAD_BYTES 400 // Request and response headers
+
+struct SimServer {
+  const char *weather;
+  const char *remote;
+  long maxAge;
+};
+
+static SimServer simServer = {"{}", "{}", -1};
+
+class HTTPClient {
+private:
+  WiFiClient *client;
+  char url[SIM_HTTP_URL_MAX];
+  const char *collected[SIM_HTTP_HEADERS];
+  size_t collectedCount;
+  char date[40];
+  char cacheControl[32];
+
+  static bool startsWith(const char *s, const char *prefix) {
+    return prefix[0] && strncmp(s, prefix, strlen(prefix)) == 0;
+  }
+
+  int request(size_t sent) {
+    simChargeCpu();
+    date[0] = cacheControl[0] = '\0';
+    if (!client || !simWifiConnected())
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    simRtc.wake.httpRequests++;
+
+    int code = HTTP_CODE_NOT_FOUND;
+    const char *body = "";
+    if (strstr(url, "/forecast.json")) {
+      code = HTTP_CODE_OK;
+      body = simServer.weather;
+      if (simServer.maxAge >= 0) {
+        snprintf(cacheControl, sizeof(cacheControl), "max-age=%ld",
+                 simServer.maxAge);
+      }
+    } else if (startsWith(url, REMOTE_API_URL)) {
+      code = HTTP_CODE_OK;
+      body = simServer.remote;
+    } else if (startsWith(url, TELEMETRY_URL)) {
+      code = HTTP_CODE_OK;
+    }
+
+    size_t length = strlen(body);
+    uint64_t bits = (uint64_t)(sent + length + SIM_HTTP_OVERHEAD_BYTES) * 8;
+    simAdvanceUs((uint64_t)simSetup.httpMs * 1000 +
+                 bits * 1000 / simSetup.httpKbps);
+
+    time_t now = simTrueTimeUs() / 1000000;
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+
+    client->simRespond(body, length);
+    return code;
+  }
+
+public:
+  HTTPClient() : client(nullptr), collectedCount(0) {
+    url[0] = date[0] = cacheControl[0] = '\0';
+  }
+
+  bool begin(WiFiClient &client, const char *url) {
+    this->client = &client;
+    strncpy(this->url, url, sizeof(this->url) - 1);
+    this->url[sizeof(this->url) - 1] = '\0';
+    return true;
+  }
+
+  void end() {
+    if (client)
+      client->stop();
+    client = nullptr;
+  }
+
+  void setTimeout(uint16_t) {}
+  void useHTTP10(bool = true) {}
+  void addHeader(const char *, const char *) {}
+
+  void collectHeaders(const char *keys[], size_t count) {
+    collectedCount = min(count, (size_t)SIM_HTTP_HEADERS);
+    memcpy(collected, keys, collectedCount * sizeof(keys[0]));
+  }
+
+  String header(const char *name) {
+    bool wanted = false;
+    for (size_t i = 0; i < collectedCount; i++) {
+      wanted |= strcasecmp(collected[i], name) == 0;
+    }
+    if (wanted && strcasecmp(name, "Date") == 0)
+      return String(date);
+    if (wanted && strcasecmp(name, "Cache-Control") == 0)
+      return String(cacheControl);
+    return String();
+  }
+
+  int GET() { return request(0); }
+  int POST(uint8_t *payload, size_t size) {
+    (void)payload;
+    return request(size);
+  }
+
+  WiFiClient &getStream() { return *client; }
+  WiFiClient *getStreamPtr() { return client; }
+};
+
+#endif // HOST_HTTPCLIENT_H
@@ -0,0 +1,117 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+
+// NVS for the wake simulator: a small key store in the sim_persist
+// section, so it outlives every wake like flash does
+
+#define SIM_NVS_ENTRIES 16
+#define SIM_NVS_NAME_MAX 16 // Namespace and key, NUL included
+#define SIM_NVS_VALUE_MAX 256
+
+struct SimNvsEntry {
+  char name[SIM_NVS_NAME_MAX];
+  char key[SIM_NVS_NAME_MAX];
+  uint16_t length; // 0 = free
+  uint8_t value[SIM_NVS_VALUE_MAX];
+};
+
+static SIM_PERSIST SimNvsEntry simNvs[SIM_NVS_ENTRIES];
+
+class Preferences {
+private:
+  char name[SIM_NVS_NAME_MAX];
+  bool open;
+  bool readOnly;
+
+  SimNvsEntry *find(const char *key) {
+    for (int i = 0; open && i < SIM_NVS_ENTRIES; i++) {
+      if (simNvs[i].length && strcmp(simNvs[i].name, name) == 0 &&
+          strcmp(simNvs[i].key, key) == 0)
+        return &simNvs[i];
+    }
+    return nullptr;
+  }
+
+  size_t put(const char *key, const void *value, size_t len) {
+    if (!open || readOnly || len == 0 || len > SIM_NVS_VALUE_MAX ||
+        strlen(key) >= SIM_NVS_NAME_MAX)
+      return 0;
+    SimNvsEntry *entry = find(key);
+    for (int i = 0; !entry && i < SIM_NVS_ENTRIES; i++) {
+      if (simNvs[i].length == 0) {
+        entry = &simNvs[i];
+        strcpy(entry->name, name);
+        strcpy(entry->key, key);
+      }
+    }
+    if (!entry)
+      return 0; // Full
+    memcpy(entry->value, value, len);
+    entry->length = len;
+    return len;
+  }
+
+  template <typename T> T get(const char *key, T fallback) {
+    SimNvsEntry *entry = find(key);
+    T value;
+    if (!entry || entry->length != sizeof(value))
+      return fallback;
+    memcpy(&value, entry->value, sizeof(value));
+    return value;
+  }
+
+public:
+  Preferences() : open(false), readOnly(false) { name[0] = '\0'; }
+
+  bool begin(const char *name, bool readOnly = false,
+             const char * = nullptr) {
+    if (strlen(name) >= SIM_NVS_NAME_MAX)
+      return false;
+    strcpy(this->name, name);
+    this->readOnly = readOnly;
+    open = true;
+    return true;
+  }
+
+  void end() { open = false; }
+
+  size_t putUChar(const char *key, uint8_t value) {
+    return put(key, &value, sizeof(value));
+  }
+  size_t putUShort(const char *key, uint16_t value) {
+    return put(key, &value, sizeof(value));
+  }
+  size_t putUInt(const char *key, uint32_t value) {
+    return put(key, &value, sizeof(value));
+  }
+  size_t putBytes(const char *key, const void *value, size_t len) {
+    return put(key, value, len);
+  }
+
+  uint8_t getUChar(const char *key, uint8_t fallback = 0) {
+    return get(key, fallback);
+  }
+  uint16_t getUShort(const char *key, uint16_t fallback = 0) {
+    return get(key, fallback);
+  }
+  uint32_t getUInt(const char *key, uint32_t fallback = 0) {
+    return get(key, fallback);
+  }
+
+  size_t getBytesLength(const char *key) {
+    SimNvsEntry *entry = find(key);
+    return entry ? entry->length : 0;
+  }
+
+  size_t getBytes(const char *key, void *buf, size_t maxLen) {
+    SimNvsEntry *entry = find(key);
+    if (!entry || entry->length > maxLen)
+      return 0;
+    memcpy(buf, entry->value, entry->length);
+    return entry->length;
+  }
+};
+
+#endif // HOST_PREFERENCES_H
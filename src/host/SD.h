@@ -0,0 +1,20 @@
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include <FS.h>
+#include <SPI.h>
+
+// SD card for the wake simulator: no card in the slot
+
+class SDFS : public fs::FS {
+public:
+  bool begin(uint8_t = 5, SPIClass & = SPI, uint32_t = 4000000,
+             const char * = "/sd", uint8_t = 5, bool = false) {
+    return false;
+  }
+  void end() {}
+};
+
+static SDFS SD;
+
+#endif // HOST_SD_H
@@ -0,0 +1,21 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stdint.h>
+
+// Arduino SPI for the wake simulator (only the SD card uses it; the panel
+// goes through driver/spi_master.h)
+
+#define VSPI 3
+#define HSPI 2
+
+class SPIClass {
+public:
+  explicit SPIClass(uint8_t = HSPI) {}
+  void begin(int8_t = -1, int8_t = -1, int8_t = -1, int8_t = -1) {}
+  void end() {}
+};
+
+static SPIClass SPI(VSPI);
+
+#endif // HOST_SPI_H
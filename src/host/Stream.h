@@ -0,0 +1,29 @@
+#ifndef HOST_STREAM_H
+#define HOST_STREAM_H
+
+#include "Print.h"
+
+// Host stand-in for the Arduino Stream class (json_stream.h reads from it)
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long) {}
+
+  size_t readBytes(uint8_t *buffer, size_t length) {
+    size_t n = 0;
+    int c;
+    while (n < length && (c = read()) >= 0)
+      buffer[n++] = c;
+    return n;
+  }
+
+  size_t readBytes(char *buffer, size_t length) {
+    return readBytes((uint8_t *)buffer, length);
+  }
+};
+
+#endif // HOST_STREAM_H
@@ -0,0 +1,270 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+
+// WiFi for the wake simulator: one access point (SimSetup::ap) that
+// associates after SimSetup::wifiMs, DNS answers after SimSetup::dnsMs.
+// The radio counts as on from WiFi.mode(WIFI_STA) to WiFi.mode(WIFI_OFF).
+// WiFiClient only carries the responses HTTPClient.h makes up.
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_MODE_NULL = 0,
+  WIFI_MODE_STA,
+  WIFI_MODE_AP,
+  WIFI_MODE_APSTA
+} wifi_mode_t;
+
+#define WIFI_OFF WIFI_MODE_NULL
+#define WIFI_STA WIFI_MODE_STA
+
+typedef enum {
+  WIFI_PS_NONE,
+  WIFI_PS_MIN_MODEM,
+  WIFI_PS_MAX_MODEM
+} wifi_ps_type_t;
+
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t ssid[33];
+  uint8_t primary;
+  int8_t rssi;
+} wifi_ap_record_t;
+
+#define SIM_WIFI_CHANNELS 13
+#define SIM_WIFI_SEARCH_MS_PER_CHANNEL 120 // Driver's own search (channel 0)
+
+class IPAddress : public Printable {
+private:
+  uint32_t address; // First octet in the low byte, as on the ESP32
+  mutable char text[16];
+
+public:
+  IPAddress() : address(0) {}
+  IPAddress(uint32_t address) : address(address) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      : address(a | b << 8 | c << 16 | (uint32_t)d << 24) {}
+
+  operator uint32_t() const { return address; }
+
+  bool fromString(const char *s) {
+    unsigned a, b, c, d;
+    char rest;
+    if (sscanf(s, "%u.%u.%u.%u%c", &a, &b, &c, &d, &rest) != 4 || a > 255 ||
+        b > 255 || c > 255 || d > 255)
+      return false;
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+
+  String toString() const {
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", address & 0xFF,
+             address >> 8 & 0xFF, address >> 16 & 0xFF, address >> 24);
+    return String(text);
+  }
+
+  size_t printTo(Print &p) const override {
+    return p.print(toString().c_str());
+  }
+};
+
+static const uint8_t simApBssid[6] = {0x24, 0x0A, 0xC4, 0x5A, 0x11, 0x01};
+
+// Results of the last scan
+static wifi_ap_record_t simScanRecords[1];
+static int16_t simScanCount;
+
+class WiFiClass {
+private:
+  wl_status_t wlStatus;
+  uint64_t connectAt; // Virtual time the association completes
+
+  void setRadio(bool on) {
+    simChargeCpu(); // Time so far was spent with the old radio state
+    simRadioOn = on;
+    if (!on) {
+      wlStatus = WL_IDLE_STATUS;
+      connectAt = UINT64_MAX;
+    }
+  }
+
+public:
+  WiFiClass() : wlStatus(WL_IDLE_STATUS), connectAt(UINT64_MAX) {}
+
+  void persistent(bool) {}
+
+  bool mode(wifi_mode_t mode) {
+    setRadio(mode != WIFI_OFF);
+    return true;
+  }
+
+  wl_status_t begin(const char *ssid, const char *, int32_t channel = 0,
+                    const uint8_t *bssid = nullptr, bool = true) {
+    if (!simRadioOn)
+      setRadio(true);
+    bool inRange = simSetup.ap[0] && strcmp(ssid, simSetup.ap) == 0 &&
+                   (channel == 0 || channel == simSetup.apChannel) &&
+                   (!bssid || memcmp(bssid, simApBssid, 6) == 0);
+    uint64_t ms = simSetup.wifiMs;
+    if (channel == 0)
+      ms += SIM_WIFI_CHANNELS * SIM_WIFI_SEARCH_MS_PER_CHANNEL;
+    wlStatus = WL_DISCONNECTED;
+    connectAt = inRange ? simRtc.nowUs + ms * 1000 : UINT64_MAX;
+    return wlStatus;
+  }
+
+  wl_status_t status() {
+    simChargeCpu();
+    if (wlStatus == WL_DISCONNECTED && simRtc.nowUs >= connectAt)
+      wlStatus = WL_CONNECTED;
+    return wlStatus;
+  }
+
+  bool disconnect(bool wifiOff = false, bool = false) {
+    wlStatus = WL_IDLE_STATUS;
+    connectAt = UINT64_MAX;
+    if (wifiOff)
+      setRadio(false);
+    return true;
+  }
+
+  int8_t RSSI() { return status() == WL_CONNECTED ? simSetup.apRssi : 0; }
+  int32_t channel() {
+    return status() == WL_CONNECTED ? simSetup.apChannel : 0;
+  }
+  uint8_t *BSSID() {
+    return status() == WL_CONNECTED ? (uint8_t *)simApBssid : nullptr;
+  }
+  IPAddress localIP() {
+    return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50)
+                                    : IPAddress();
+  }
+
+  uint8_t *macAddress(uint8_t *mac) {
+    static const uint8_t address[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+    memcpy(mac, address, sizeof(address));
+    return mac;
+  }
+
+  bool setSleep(bool) { return true; }
+  bool setSleep(wifi_ps_type_t) { return true; }
+
+  // Blocking active scan over all channels
+  int16_t scanNetworks(bool = false, bool = false, bool = false,
+                       uint32_t msPerChannel = 300, uint8_t = 0) {
+    if (!simRadioOn)
+      setRadio(true);
+    simChargeCpu();
+    simAdvanceUs((uint64_t)SIM_WIFI_CHANNELS * msPerChannel * 1000);
+    simScanCount = 0;
+    if (simSetup.ap[0]) {
+      wifi_ap_record_t &ap = simScanRecords[simScanCount++];
+      memcpy(ap.bssid, simApBssid, sizeof(ap.bssid));
+      strncpy((char *)ap.ssid, simSetup.ap, sizeof(ap.ssid) - 1);
+      ap.ssid[sizeof(ap.ssid) - 1] = '\0';
+      ap.primary = simSetup.apChannel;
+      ap.rssi = simSetup.apRssi;
+    }
+    return simScanCount;
+  }
+
+  static void *getScanInfoByIndex(int i) {
+    return i >= 0 && i < simScanCount ? &simScanRecords[i] : nullptr;
+  }
+
+  void scanDelete() { simScanCount = 0; }
+
+  // Every name resolves, to a documentation address
+  int hostByName(const char *, IPAddress &ip) {
+    if (status() != WL_CONNECTED)
+      return 0;
+    simAdvanceUs((uint64_t)simSetup.dnsMs * 1000);
+    ip = IPAddress(203, 0, 113, 10);
+    return 1;
+  }
+};
+
+static WiFiClass WiFi;
+
+bool simWifiConnected() { return WiFi.status() == WL_CONNECTED; }
+
+class WiFiClient : public Stream {
+private:
+  const char *body; // Response body set by HTTPClient
+  size_t length;
+  size_t pos;
+  bool open;
+
+public:
+  WiFiClient() : body(nullptr), length(0), pos(0), open(false) {}
+  virtual ~WiFiClient() {}
+
+  int connect(IPAddress, uint16_t, int32_t) {
+    body = nullptr;
+    length = pos = 0;
+    open = simWifiConnected();
+    return open;
+  }
+
+  virtual int connect(IPAddress ip, uint16_t port) {
+    return WiFiClient::connect(ip, port, 3000);
+  }
+
+  virtual int connect(const char *host, uint16_t port) {
+    IPAddress ip;
+    return WiFi.hostByName(host, ip) && WiFiClient::connect(ip, port, 3000);
+  }
+
+  // The next response, served from memory
+  void simRespond(const char *data, size_t size) {
+    open = true;
+    body = data;
+    length = size;
+    pos = 0;
+  }
+
+  int fd() const { return -1; }
+
+  size_t write(uint8_t) override { return open ? 1 : 0; }
+  size_t write(const uint8_t *, size_t size) override {
+    return open ? size : 0;
+  }
+
+  int available() override { return open ? length - pos : 0; }
+  int read() override {
+    return open && pos < length ? (uint8_t)body[pos++] : -1;
+  }
+  virtual int read(uint8_t *buf, size_t size) {
+    size_t n = min(size, (size_t)available());
+    if (n == 0)
+      return -1;
+    memcpy(buf, body + pos, n);
+    pos += n;
+    return n;
+  }
+  int peek() override {
+    return open && pos < length ? (uint8_t)body[pos] : -1;
+  }
+  virtual void flush() {}
+
+  virtual void stop() {
+    open = false;
+    body = nullptr;
+    length = pos = 0;
+  }
+
+  // Open until the body has been read, like a server that closes after it
+  virtual uint8_t connected() { return open && (!body || pos < length); }
+};
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,168 @@
+// Host benchmarks for the per-wake CPU work ([env:native_bench]).
+//
+// Runs include/benchmark.h on the forecast.json fixtures in bench/ and
+// prints time, heap allocations and bytes per call. A case fails when it
+// allocates more than its budget, or is slower than in the recorded
+// baseline by more than BENCH_TOLERANCE_PCT and BENCH_TOLERANCE_NS (sub-
+// microsecond cases jitter by more than a percentage). Exit status 1 on
+// any failure.
+//
+//   program [--fixtures DIR] [--baseline FILE] [--record]
+//
+// --record writes this run as the new baseline. Baselines are per
+// machine: record one on the machine that runs the check.
+
+#include "benchmark.h"
+#include "canvas.h"
+#include "config.h"
+#include <Arduino.h>
+
+#define BENCH_TOLERANCE_PCT 50
+#define BENCH_TOLERANCE_NS 500
+#define BENCH_PATH_MAX 256
+
+struct BenchBaseline {
+  char names[BENCH_MAX_CASES][32];
+  uint32_t ns[BENCH_MAX_CASES];
+  int count;
+};
+
+// Whole file as a NUL-terminated string (nullptr if unreadable)
+static char *readFile(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return nullptr;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *data = (char *)malloc(size + 1);
+  if (data && fread(data, 1, size, f) != (size_t)size) {
+    free(data);
+    data = nullptr;
+  }
+  fclose(f);
+  if (data)
+    data[size] = '\0';
+  return data;
+}
+
+static char *readFixture(const char *dir, const char *name) {
+  char path[BENCH_PATH_MAX];
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  char *data = readFile(path);
+  if (!data) {
+    fprintf(stderr, "Cannot read %s\n", path);
+  } else {
+    printf("Fixture %-22s %6u bytes\n", name, (unsigned)strlen(data));
+  }
+  return data;
+}
+
+// Baseline file: one "<case> <ns per call>" line per case
+static bool loadBaseline(const char *path, BenchBaseline &baseline) {
+  baseline.count = 0;
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  unsigned long ns;
+  while (baseline.count < BENCH_MAX_CASES &&
+         fscanf(f, "%31s %lu", baseline.names[baseline.count], &ns) == 2) {
+    baseline.ns[baseline.count++] = ns;
+  }
+  fclose(f);
+  return true;
+}
+
+static const uint32_t *findBaseline(const BenchBaseline &baseline,
+                                    const char *name) {
+  for (int i = 0; i < baseline.count; i++) {
+    if (strcmp(baseline.names[i], name) == 0)
+      return &baseline.ns[i];
+  }
+  return nullptr;
+}
+
+static bool saveBaseline(const char *path, const BenchResults &results) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  for (int i = 0; i < results.count; i++) {
+    fprintf(f, "%s %lu\n", results.cases[i].name,
+            (unsigned long)results.cases[i].ns);
+  }
+  return fclose(f) == 0;
+}
+
+int main(int argc, char **argv) {
+  const char *fixtures = "bench";
+  const char *baselinePath = "bench/baseline.txt";
+  bool record = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--fixtures") == 0 && i + 1 < argc) {
+      fixtures = argv[++i];
+    } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baselinePath = argv[++i];
+    } else if (strcmp(argv[i], "--record") == 0) {
+      record = true;
+    } else {
+      fprintf(stderr, "usage: %s [--fixtures DIR] [--baseline FILE] "
+                      "[--record]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  BenchPayloads payloads;
+  payloads.small = readFixture(fixtures, "forecast_small.json");
+  payloads.medium = readFixture(fixtures, "forecast_medium.json");
+  payloads.large = readFixture(fixtures, "forecast_large.json");
+  if (!payloads.small || !payloads.medium || !payloads.large)
+    return 2;
+
+  static BenchBaseline baseline;
+  bool haveBaseline = !record && loadBaseline(baselinePath, baseline);
+  if (!record && !haveBaseline) {
+    printf("No baseline in %s: times are not checked (--record)\n",
+           baselinePath);
+  }
+
+  static Canvas canvas;
+  static BenchResults results;
+  printf("=== Benchmarks (%d x %d iterations, heap %s) ===\n", BENCH_ROUNDS,
+         BENCH_ITERATIONS,
+#ifdef HEAP_ACCOUNTING
+         "counted"
+#else
+         "not counted"
+#endif
+  );
+  runBenchmarks(canvas, payloads, results);
+
+  int failures = 0;
+  for (int i = 0; i < results.count; i++) {
+    const BenchResult &r = results.cases[i];
+    const uint32_t *base = haveBaseline ? findBaseline(baseline, r.name)
+                                        : nullptr;
+    bool slow = base &&
+                (uint64_t)r.ns * 100 >
+                    (uint64_t)*base * (100 + BENCH_TOLERANCE_PCT) &&
+                r.ns > *base + BENCH_TOLERANCE_NS;
+    bool allocs = r.maxAllocs >= 0 && (int)r.allocs > r.maxAllocs;
+    failures += slow || allocs;
+
+    printf("BENCH %-22s %10.3f us %4lu allocs %6lu bytes", r.name,
+           r.ns / 1000.0, (unsigned long)r.allocs, (unsigned long)r.bytes);
+    if (base)
+      printf("  (baseline %.3f us)", *base / 1000.0);
+    printf("  %s\n", slow || allocs ? "REGRESSION" : "ok");
+  }
+
+  if (record) {
+    if (!saveBaseline(baselinePath, results)) {
+      fprintf(stderr, "Cannot write %s\n", baselinePath);
+      return 2;
+    }
+    printf("Baseline written to %s\n", baselinePath);
+  }
+  printf("=== Benchmarks done: %d regression(s) ===\n", failures);
+  return failures > 0 ? 1 : 0;
+}
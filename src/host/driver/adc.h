@@ -0,0 +1,19 @@
+#ifndef HOST_DRIVER_ADC_H
+#define HOST_DRIVER_ADC_H
+
+#include "esp_system.h"
+
+// ADC driver for the wake simulator: the ULP's battery sampling is not
+// simulated (analogRead() is, in sim_device.h)
+
+typedef enum { ADC1_CHANNEL_0, ADC1_CHANNEL_7 = 7 } adc1_channel_t;
+typedef enum { ADC_WIDTH_BIT_12 = 3 } adc_bits_width_t;
+typedef enum { ADC_ATTEN_DB_11 = 3 } adc_atten_t;
+
+inline esp_err_t adc1_config_width(adc_bits_width_t) { return ESP_OK; }
+inline esp_err_t adc1_config_channel_atten(adc1_channel_t, adc_atten_t) {
+  return ESP_OK;
+}
+inline void adc1_ulp_enable() {}
+
+#endif // HOST_DRIVER_ADC_H
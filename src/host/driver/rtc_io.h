@@ -0,0 +1,20 @@
+#ifndef HOST_DRIVER_RTC_IO_H
+#define HOST_DRIVER_RTC_IO_H
+
+#include "driver/gpio.h"
+#include "esp_system.h"
+
+// RTC GPIO driver for the wake simulator (the button never changes)
+
+typedef enum { RTC_GPIO_MODE_INPUT_ONLY } rtc_gpio_mode_t;
+
+inline esp_err_t rtc_gpio_init(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_deinit(gpio_num_t) { return ESP_OK; }
+inline esp_err_t rtc_gpio_set_direction(gpio_num_t, rtc_gpio_mode_t) {
+  return ESP_OK;
+}
+inline int rtc_io_number_get(gpio_num_t gpio) {
+  return gpio == GPIO_NUM_39 ? 3 : -1; // Only the button is asked for
+}
+
+#endif // HOST_DRIVER_RTC_IO_H
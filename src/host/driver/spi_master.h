@@ -0,0 +1,74 @@
+#ifndef HOST_DRIVER_SPI_MASTER_H
+#define HOST_DRIVER_SPI_MASTER_H
+
+#include "sim_device.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// SPI master driver for the wake simulator: the panel is the only device,
+// and every transfer goes to its model in sim_device.h
+
+typedef enum { SPI1_HOST, SPI2_HOST, SPI3_HOST } spi_host_device_t;
+
+#define SPI_DMA_CH_AUTO 3
+#define SPI_DEVICE_HALFDUPLEX (1 << 4)
+#define SPI_TRANS_USE_TXDATA (1 << 3)
+
+typedef struct {
+  int mosi_io_num;
+  int miso_io_num;
+  int sclk_io_num;
+  int quadwp_io_num;
+  int quadhd_io_num;
+  int max_transfer_sz;
+} spi_bus_config_t;
+
+typedef struct {
+  int clock_speed_hz;
+  uint8_t mode;
+  int spics_io_num;
+  uint32_t flags;
+  int queue_size;
+} spi_device_interface_config_t;
+
+typedef struct {
+  uint32_t flags;
+  size_t length; // Bits
+  const void *tx_buffer;
+  uint8_t tx_data[4];
+} spi_transaction_t;
+
+struct spi_device_t {
+  int clockHz;
+};
+typedef spi_device_t *spi_device_handle_t;
+
+inline esp_err_t spi_bus_initialize(spi_host_device_t,
+                                    const spi_bus_config_t *, int) {
+  return ESP_OK;
+}
+
+inline esp_err_t spi_bus_add_device(spi_host_device_t,
+                                    const spi_device_interface_config_t *dev,
+                                    spi_device_handle_t *handle) {
+  static spi_device_t panel;
+  panel.clockHz = dev->clock_speed_hz;
+  *handle = &panel;
+  return ESP_OK;
+}
+
+inline esp_err_t spi_device_transmit(spi_device_handle_t handle,
+                                     spi_transaction_t *t) {
+  const uint8_t *bytes = (t->flags & SPI_TRANS_USE_TXDATA)
+                             ? t->tx_data
+                             : (const uint8_t *)t->tx_buffer;
+  simPanelWrite(bytes, t->length / 8, handle->clockHz);
+  return ESP_OK;
+}
+
+inline esp_err_t spi_device_polling_transmit(spi_device_handle_t handle,
+                                             spi_transaction_t *t) {
+  return spi_device_transmit(handle, t);
+}
+
+#endif // HOST_DRIVER_SPI_MASTER_H
@@ -0,0 +1,51 @@
+#ifndef HOST_ESP32_ULP_H
+#define HOST_ESP32_ULP_H
+
+#include "esp_system.h"
+#include "sim_device.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// ULP coprocessor for the wake simulator. The program is assembled into
+// nothing and never runs: no button gestures, no battery wakes. Its
+// variables in RTC slow memory keep their values across wakes.
+
+typedef struct {
+  uint32_t instruction;
+} ulp_insn_t;
+
+enum { R0, R1, R2, R3 };
+
+static SIM_PERSIST uint32_t RTC_SLOW_MEM[2048];
+
+template <typename... Args> inline ulp_insn_t simUlpInsn(Args...) {
+  return ulp_insn_t();
+}
+
+#define I_MOVI(...) simUlpInsn(__VA_ARGS__)
+#define I_MOVR(...) simUlpInsn(__VA_ARGS__)
+#define I_LD(...) simUlpInsn(__VA_ARGS__)
+#define I_ST(...) simUlpInsn(__VA_ARGS__)
+#define I_ADDI(...) simUlpInsn(__VA_ARGS__)
+#define I_SUBR(...) simUlpInsn(__VA_ARGS__)
+#define I_ADC(...) simUlpInsn(__VA_ARGS__)
+#define I_RD_REG(...) simUlpInsn(__VA_ARGS__)
+#define I_WAKE() simUlpInsn()
+#define I_END() simUlpInsn()
+#define I_HALT() simUlpInsn()
+#define M_LABEL(...) simUlpInsn(__VA_ARGS__)
+#define M_BL(...) simUlpInsn(__VA_ARGS__)
+#define M_BGE(...) simUlpInsn(__VA_ARGS__)
+#define M_BX(...) simUlpInsn(__VA_ARGS__)
+#define M_BXF(...) simUlpInsn(__VA_ARGS__)
+
+inline esp_err_t ulp_process_macros_and_load(uint32_t, const ulp_insn_t *,
+                                             size_t *size) {
+  *size = 64; // About what the real program assembles to
+  return ESP_OK;
+}
+
+inline esp_err_t ulp_set_wakeup_period(size_t, uint32_t) { return ESP_OK; }
+inline esp_err_t ulp_run(uint32_t) { return ESP_OK; }
+
+#endif // HOST_ESP32_ULP_H
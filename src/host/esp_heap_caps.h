@@ -0,0 +1,15 @@
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// heap_stats.h reports the ESP32 heap; the host has no such figures
+
+#define MALLOC_CAP_8BIT (1 << 2)
+
+inline unsigned heap_caps_get_free_size(uint32_t) { return 0; }
+inline unsigned heap_caps_get_minimum_free_size(uint32_t) { return 0; }
+inline unsigned heap_caps_get_largest_free_block(uint32_t) { return 0; }
+
+#endif // HOST_ESP_HEAP_CAPS_H
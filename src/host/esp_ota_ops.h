@@ -0,0 +1,42 @@
+#ifndef HOST_ESP_OTA_OPS_H
+#define HOST_ESP_OTA_OPS_H
+
+#include "esp_partition.h"
+#include "esp_system.h"
+
+// OTA for the wake simulator: the factory app runs and there is no update
+// partition, so offered updates are skipped
+
+typedef uint32_t esp_ota_handle_t;
+
+inline const esp_partition_t *esp_ota_get_running_partition() {
+  return &simFactoryPartition;
+}
+
+inline const esp_partition_t *
+esp_ota_get_next_update_partition(const esp_partition_t *) {
+  return nullptr;
+}
+
+inline esp_err_t esp_ota_begin(const esp_partition_t *, size_t,
+                               esp_ota_handle_t *) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+inline esp_err_t esp_ota_write(esp_ota_handle_t, const void *, size_t) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+inline esp_err_t esp_ota_end(esp_ota_handle_t) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+inline esp_err_t esp_ota_abort(esp_ota_handle_t) { return ESP_OK; }
+
+inline esp_err_t esp_ota_set_boot_partition(const esp_partition_t *) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+inline esp_err_t esp_ota_mark_app_valid_cancel_rollback() { return ESP_OK; }
+
+#endif // HOST_ESP_OTA_OPS_H
@@ -0,0 +1,61 @@
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include "esp_system.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Partition table for the wake simulator: a single factory app, so there
+// is never anywhere to install an update or roll back to
+
+typedef enum {
+  ESP_PARTITION_TYPE_APP = 0x00,
+  ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef enum {
+  ESP_PARTITION_SUBTYPE_APP_FACTORY = 0x00,
+  ESP_PARTITION_SUBTYPE_ANY = 0xff
+} esp_partition_subtype_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  esp_partition_subtype_t subtype;
+  uint32_t address;
+  uint32_t size;
+  char label[17];
+} esp_partition_t;
+
+typedef struct esp_partition_iterator_opaque_ *esp_partition_iterator_t;
+
+static const esp_partition_t simFactoryPartition = {
+    ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_FACTORY, 0x10000,
+    0x300000, "factory"};
+
+inline esp_partition_iterator_t esp_partition_find(esp_partition_type_t,
+                                                   esp_partition_subtype_t,
+                                                   const char *) {
+  return nullptr; // Nothing besides the running app
+}
+
+inline esp_partition_iterator_t esp_partition_next(esp_partition_iterator_t) {
+  return nullptr;
+}
+
+inline const esp_partition_t *esp_partition_get(esp_partition_iterator_t) {
+  return nullptr;
+}
+
+inline void esp_partition_iterator_release(esp_partition_iterator_t) {}
+
+inline esp_err_t esp_partition_read(const esp_partition_t *, size_t, void *,
+                                    size_t) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+inline esp_err_t esp_partition_get_sha256(const esp_partition_t *,
+                                          uint8_t *) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // HOST_ESP_PARTITION_H
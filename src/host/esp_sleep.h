@@ -0,0 +1,66 @@
+#ifndef HOST_ESP_SLEEP_H
+#define HOST_ESP_SLEEP_H
+
+#include "driver/gpio.h"
+#include "esp_system.h"
+#include "sim_device.h"
+#include <stdint.h>
+
+// Deep sleep for the wake simulator: esp_deep_sleep_start() ends the wake
+// and sim_cli.cpp sleeps for the armed timer before starting the next one
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+  ESP_SLEEP_WAKEUP_TOUCHPAD,
+  ESP_SLEEP_WAKEUP_ULP,
+  ESP_SLEEP_WAKEUP_GPIO,
+  ESP_SLEEP_WAKEUP_UART
+} esp_sleep_wakeup_cause_t;
+
+typedef esp_sleep_wakeup_cause_t esp_sleep_source_t;
+
+typedef enum {
+  ESP_PD_DOMAIN_RTC_PERIPH,
+  ESP_PD_DOMAIN_RTC_SLOW_MEM,
+  ESP_PD_DOMAIN_RTC_FAST_MEM
+} esp_sleep_pd_domain_t;
+
+typedef enum {
+  ESP_PD_OPTION_OFF,
+  ESP_PD_OPTION_ON,
+  ESP_PD_OPTION_AUTO
+} esp_sleep_pd_option_t;
+
+inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return (esp_sleep_wakeup_cause_t)simRtc.wakeCause;
+}
+
+inline esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) {
+  simRtc.wake.sleepUs = us;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t, int) {
+  return ESP_OK;
+}
+
+inline esp_err_t esp_sleep_enable_ulp_wakeup() { return ESP_OK; }
+
+inline esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+  if (source == ESP_SLEEP_WAKEUP_TIMER || source == ESP_SLEEP_WAKEUP_ALL)
+    simRtc.wake.sleepUs = 0;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t,
+                                     esp_sleep_pd_option_t) {
+  return ESP_OK;
+}
+
+[[noreturn]] inline void esp_deep_sleep_start() { simEndWake(false); }
+
+#endif // HOST_ESP_SLEEP_H
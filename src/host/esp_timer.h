@@ -0,0 +1,57 @@
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include "esp_system.h"
+#include "sim_device.h"
+#include <stdint.h>
+
+// High resolution timer for the wake simulator: one timer (the wake
+// budget's), whose callback runs when the virtual clock passes it
+
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum { ESP_TIMER_TASK, ESP_TIMER_ISR } esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void *arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char *name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void *arg;
+};
+typedef esp_timer *esp_timer_handle_t;
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t *args,
+                                  esp_timer_handle_t *handle) {
+  static esp_timer timer;
+  timer.callback = args->callback;
+  timer.arg = args->arg;
+  *handle = &timer;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t timer,
+                                      uint64_t timeoutUs) {
+  simChargeCpu();
+  simTimerCallback = timer->callback;
+  simTimerArg = timer->arg;
+  simTimerAt = simRtc.nowUs + timeoutUs;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_stop(esp_timer_handle_t) {
+  simTimerAt = 0;
+  return ESP_OK;
+}
+
+inline int64_t esp_timer_get_time() {
+  simChargeCpu();
+  return simRtc.nowUs - simWakeStartUs;
+}
+
+#endif // HOST_ESP_TIMER_H
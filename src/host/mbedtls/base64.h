@@ -0,0 +1,117 @@
+#ifndef HOST_MBEDTLS_BASE64_H
+#define HOST_MBEDTLS_BASE64_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The two mbedTLS base64 calls the firmware makes, with the same
+// signatures, return codes and output lengths (the native platform has no
+// mbedTLS)
+
+#define MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL -0x002A
+#define MBEDTLS_ERR_BASE64_INVALID_CHARACTER -0x002C
+
+static const char HOST_BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+inline int mbedtls_base64_encode(unsigned char *dst, size_t dlen,
+                                 size_t *olen, const unsigned char *src,
+                                 size_t slen) {
+  if (slen == 0) {
+    *olen = 0;
+    return 0;
+  }
+  size_t needed = (slen + 2) / 3 * 4;
+  if (dlen < needed + 1) {
+    *olen = needed + 1;
+    return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+  }
+  unsigned char *p = dst;
+  for (size_t i = 0; i < slen; i += 3) {
+    uint32_t chunk = (uint32_t)src[i] << 16;
+    if (i + 1 < slen)
+      chunk |= (uint32_t)src[i + 1] << 8;
+    if (i + 2 < slen)
+      chunk |= src[i + 2];
+    *p++ = HOST_BASE64_CHARS[(chunk >> 18) & 0x3F];
+    *p++ = HOST_BASE64_CHARS[(chunk >> 12) & 0x3F];
+    *p++ = i + 1 < slen ? HOST_BASE64_CHARS[(chunk >> 6) & 0x3F] : '=';
+    *p++ = i + 2 < slen ? HOST_BASE64_CHARS[chunk & 0x3F] : '=';
+  }
+  *p = '\0';
+  *olen = p - dst;
+  return 0;
+}
+
+inline int hostBase64Value(unsigned char c) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '+')
+    return 62;
+  if (c == '/')
+    return 63;
+  return -1;
+}
+
+// Like mbedTLS: line breaks are skipped, "=" only at the end, and a
+// missing or too small dst reports the size needed in olen
+inline int mbedtls_base64_decode(unsigned char *dst, size_t dlen,
+                                 size_t *olen, const unsigned char *src,
+                                 size_t slen) {
+  size_t digits = 0, pad = 0;
+  for (size_t i = 0; i < slen; i++) {
+    if (src[i] == '\r' || src[i] == '\n')
+      continue;
+    if (src[i] == '=') {
+      if (++pad > 2)
+        return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+    } else if (pad > 0 || hostBase64Value(src[i]) < 0) {
+      return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+    } else {
+      digits++;
+    }
+  }
+  if (digits + pad == 0) {
+    *olen = 0;
+    return 0;
+  }
+  if ((digits + pad) % 4 != 0) {
+    return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+  }
+  size_t needed = (digits + pad) / 4 * 3 - pad;
+  if (dst == nullptr || dlen < needed) {
+    *olen = needed;
+    return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+  }
+
+  uint32_t bits = 0;
+  int count = 0;
+  unsigned char *p = dst;
+  for (size_t i = 0; i < slen; i++) {
+    int v = hostBase64Value(src[i]);
+    if (v < 0)
+      continue;
+    bits = (bits << 6) | v;
+    if (++count == 4) {
+      *p++ = bits >> 16;
+      *p++ = bits >> 8;
+      *p++ = bits;
+      bits = 0;
+      count = 0;
+    }
+  }
+  if (count == 3) { // One "=" of padding
+    *p++ = bits >> 10;
+    *p++ = bits >> 2;
+  } else if (count == 2) { // Two
+    *p++ = bits >> 4;
+  }
+  *olen = p - dst;
+  return 0;
+}
+
+#endif // HOST_MBEDTLS_BASE64_H
@@ -0,0 +1,8 @@
+#ifndef HOST_MBEDTLS_PLATFORM_H
+#define HOST_MBEDTLS_PLATFORM_H
+
+#include <stdlib.h>
+
+#define mbedtls_free free
+
+#endif // HOST_MBEDTLS_PLATFORM_H
@@ -0,0 +1,145 @@
+#ifndef HOST_MBEDTLS_SSL_H
+#define HOST_MBEDTLS_SSL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// mbedTLS for the wake simulator: enough to build tls_client.h. HTTPS is
+// not simulated, every handshake fails.
+
+#define MBEDTLS_SSL_KEEP_PEER_CERTIFICATE
+
+#define MBEDTLS_SSL_IS_CLIENT 0
+#define MBEDTLS_SSL_TRANSPORT_STREAM 0
+#define MBEDTLS_SSL_PRESET_DEFAULT 0
+#define MBEDTLS_SSL_SESSION_TICKETS_ENABLED 1
+#define MBEDTLS_SSL_VERIFY_NONE 0
+#define MBEDTLS_SSL_VERIFY_OPTIONAL 1
+#define MBEDTLS_SSL_VERIFY_REQUIRED 2
+#define MBEDTLS_X509_BADCERT_NOT_TRUSTED 0x08
+
+#define MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE -0x7080
+#define MBEDTLS_ERR_SSL_TIMEOUT -0x6800
+#define MBEDTLS_ERR_SSL_WANT_WRITE -0x6880
+#define MBEDTLS_ERR_SSL_WANT_READ -0x6900
+
+typedef struct {
+  int unused;
+} mbedtls_ssl_context, mbedtls_ssl_config, mbedtls_ctr_drbg_context,
+    mbedtls_entropy_context;
+
+typedef struct {
+  unsigned char *p;
+  size_t len;
+} mbedtls_x509_buf;
+
+typedef struct mbedtls_x509_crt {
+  mbedtls_x509_buf raw;
+} mbedtls_x509_crt;
+
+typedef struct {
+  int fd;
+} mbedtls_net_context;
+
+typedef struct {
+  mbedtls_x509_crt *peer_cert;
+} mbedtls_ssl_session;
+
+typedef int (*mbedtls_rng_t)(void *, unsigned char *, size_t);
+typedef int (*mbedtls_send_t)(void *, const unsigned char *, size_t);
+typedef int (*mbedtls_recv_t)(void *, unsigned char *, size_t);
+typedef int (*mbedtls_verify_t)(void *, mbedtls_x509_crt *, int, uint32_t *);
+
+inline void mbedtls_ssl_init(mbedtls_ssl_context *) {}
+inline void mbedtls_ssl_free(mbedtls_ssl_context *) {}
+inline void mbedtls_ssl_config_init(mbedtls_ssl_config *) {}
+inline void mbedtls_ssl_config_free(mbedtls_ssl_config *) {}
+inline void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context *) {}
+inline void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context *) {}
+inline void mbedtls_entropy_init(mbedtls_entropy_context *) {}
+inline void mbedtls_entropy_free(mbedtls_entropy_context *) {}
+inline void mbedtls_x509_crt_init(mbedtls_x509_crt *crt) { crt->raw.len = 0; }
+inline void mbedtls_x509_crt_free(mbedtls_x509_crt *) {}
+inline void mbedtls_ssl_session_init(mbedtls_ssl_session *session) {
+  session->peer_cert = NULL;
+}
+inline void mbedtls_ssl_session_free(mbedtls_ssl_session *) {}
+
+inline int mbedtls_entropy_func(void *, unsigned char *, size_t) { return 0; }
+inline int mbedtls_ctr_drbg_random(void *, unsigned char *, size_t) {
+  return 0;
+}
+inline int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context *, mbedtls_rng_t,
+                                 void *, const unsigned char *, size_t) {
+  return 0;
+}
+
+inline int mbedtls_ssl_config_defaults(mbedtls_ssl_config *, int, int, int) {
+  return 0;
+}
+inline void mbedtls_ssl_conf_rng(mbedtls_ssl_config *, mbedtls_rng_t,
+                                 void *) {}
+inline void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config *, int) {}
+inline void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *, int) {}
+inline void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config *,
+                                      mbedtls_x509_crt *, void *) {}
+inline void mbedtls_ssl_conf_verify(mbedtls_ssl_config *, mbedtls_verify_t,
+                                    void *) {}
+inline int mbedtls_x509_crt_parse(mbedtls_x509_crt *, const unsigned char *,
+                                  size_t) {
+  return 0;
+}
+
+inline int mbedtls_ssl_setup(mbedtls_ssl_context *,
+                             const mbedtls_ssl_config *) {
+  return 0;
+}
+inline int mbedtls_ssl_set_hostname(mbedtls_ssl_context *, const char *) {
+  return 0;
+}
+inline int mbedtls_net_send(void *, const unsigned char *, size_t) {
+  return -1;
+}
+inline int mbedtls_net_recv(void *, unsigned char *, size_t) { return -1; }
+inline void mbedtls_ssl_set_bio(mbedtls_ssl_context *, void *, mbedtls_send_t,
+                                mbedtls_recv_t, void *) {}
+
+inline int mbedtls_ssl_session_load(mbedtls_ssl_session *,
+                                    const unsigned char *, size_t) {
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+inline int mbedtls_ssl_session_save(const mbedtls_ssl_session *,
+                                    unsigned char *, size_t, size_t *olen) {
+  *olen = 0;
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+inline int mbedtls_ssl_set_session(mbedtls_ssl_context *,
+                                   const mbedtls_ssl_session *) {
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+inline int mbedtls_ssl_get_session(const mbedtls_ssl_context *,
+                                   mbedtls_ssl_session *) {
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+
+inline int mbedtls_ssl_handshake(mbedtls_ssl_context *) {
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+inline uint32_t mbedtls_ssl_get_verify_result(const mbedtls_ssl_context *) {
+  return MBEDTLS_X509_BADCERT_NOT_TRUSTED;
+}
+inline int mbedtls_ssl_write(mbedtls_ssl_context *, const unsigned char *,
+                             size_t) {
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+inline int mbedtls_ssl_read(mbedtls_ssl_context *, unsigned char *, size_t) {
+  return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+inline size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *) {
+  return 0;
+}
+inline int mbedtls_ssl_close_notify(mbedtls_ssl_context *) { return 0; }
+inline int mbedtls_ssl_session_reset(mbedtls_ssl_context *) { return 0; }
+
+#endif // HOST_MBEDTLS_SSL_H
@@ -0,0 +1,7 @@
+#ifndef HOST_MBEDTLS_X509_CRT_H
+#define HOST_MBEDTLS_X509_CRT_H
+
+// Declared with the rest of the TLS stand-in
+#include "ssl.h"
+
+#endif // HOST_MBEDTLS_X509_CRT_H
@@ -0,0 +1,56 @@
+// Host frame renderer for remote-mode frames ([env:native_render]).
+//
+// Reads one render request per line on stdin (see
+// include/frame_renderer.h), draws it with the main screen code and
+// answers each on stdout with "FRAME <bytes> <base64>" (the framebuffer
+// in panel RAM layout) or "ERROR <reason>". tools/render_frames.py runs
+// it for a batch of requests.
+
+#include "canvas.h"
+#include "config.h"
+#include "frame_renderer.h"
+#include "json_arena.h"
+#include <Arduino.h>
+#include <mbedtls/base64.h>
+
+#define RENDER_BASE64_SIZE (((PANEL_BUFFER_SIZE + 2) / 3) * 4 + 1)
+
+static char renderLine[RENDER_LINE_MAX];
+static uint8_t renderArenaBuffer[RENDER_ARENA_SIZE];
+static char renderBase64[RENDER_BASE64_SIZE];
+
+int main() {
+  static Canvas canvas;
+  static JsonArena arena(renderArenaBuffer, sizeof(renderArenaBuffer));
+
+  while (fgets(renderLine, sizeof(renderLine), stdin)) {
+    size_t len = strlen(renderLine);
+    if (len > 0 && renderLine[len - 1] != '\n' && !feof(stdin)) {
+      // Drop the rest of an oversized line
+      int c;
+      while ((c = getchar()) != EOF && c != '\n') {
+      }
+      printf("ERROR line too long\n");
+      fflush(stdout);
+      continue;
+    }
+    while (len > 0 && (renderLine[len - 1] == '\n' ||
+                       renderLine[len - 1] == '\r'))
+      renderLine[--len] = '\0';
+    if (len == 0)
+      continue;
+
+    const char *error = renderFrame(canvas, arena, renderLine);
+    if (error) {
+      printf("ERROR %s\n", error);
+    } else {
+      size_t encoded = 0;
+      mbedtls_base64_encode((unsigned char *)renderBase64,
+                            sizeof(renderBase64), &encoded,
+                            canvas.getFrameBuffer(), PANEL_BUFFER_SIZE);
+      printf("FRAME %d %s\n", PANEL_BUFFER_SIZE, renderBase64);
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,391 @@
+// Wake simulator ([env:native_sim]).
+//
+// Runs the real setup() from src/main.cpp once per wake against the
+// simulated ESP32 in src/host/ (sim_device.h and the WiFi, HTTPClient,
+// esp_sleep, ... shims): a virtual clock, one WiFi access point, a mock
+// HTTP server and the panel's BUSY timing. Each wake runs in a child
+// process, so it starts from a fresh boot; what survives deep sleep
+// (RTC_DATA_ATTR, NVS, the RTC clock) is carried into the next one. The
+// wake ends where the firmware enters deep sleep, and the simulated time
+// jumps ahead by the timer wakeup it armed.
+//
+// Per simulated day it prints wakes, active and radio-on time, HTTP
+// requests and panel refreshes, and turns them into mAh/day and days per
+// charge with the current model from config.h (POWER_MA_*, each can be
+// overridden). The device's own energy ledger (energy_model.h) is printed
+// next to it for comparison.
+//
+//   program [--days N] [--start EPOCH] [--weather FILE] [--remote FILE]
+//           [--max-age SEC] [--ap SSID|none] [--rssi DBM] [--battery PCT]
+//           [--<timing>-ms MS] [--http-kbps N] [--cpu-scale X]
+//           [--ma-cpu-base MA] [--ma-per-mhz MA] [--ma-radio MA]
+//           [--ma-sleep MA] [--mas-full MAS] [--mas-partial MAS]
+//           [--capacity MAH] [--log]
+//
+// The configuration simulated is the one in config.h; a "config" object
+// in the --remote response changes it at run time, as a server would.
+// --cpu-scale is how much slower the ESP32 at 240 MHz runs the firmware
+// than this machine (0: count no CPU time, for repeatable runs). --log
+// shows the device's serial output on stderr.
+//
+// Not simulated: HTTPS (handshakes fail), the SD card (absent), OTA
+// (nowhere to install), the button and the ULP's battery wakes.
+
+#include "../main.cpp"
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SIM_DAY_US ((uint64_t)86400 * 1000000)
+#define SIM_MAX_DAYS 365
+
+// Current model, mA (and mA*s per refresh)
+struct SimCurrents {
+  double cpuBase;
+  double perMhz;
+  double radio;
+  double sleep;
+  double fullRefresh;
+  double partialRefresh;
+  double capacity; // mAh
+};
+
+struct SimDay {
+  uint32_t wakes;
+  uint64_t activeUs;
+  uint64_t mhzUs;
+  uint64_t radioUs;
+  uint64_t sleepUs;
+  uint32_t httpRequests;
+  uint32_t fullRefreshes;
+  uint32_t partialRefreshes;
+};
+
+// Where a wake leaves the sim_persist section for the next one
+extern "C" char __start_sim_persist[], __stop_sim_persist[];
+static uint8_t *simCarry;
+
+[[noreturn]] void simEndWake(bool restart) {
+  simChargeCpu();
+  simRtc.wake.restarted = restart;
+  memcpy(simCarry, __start_sim_persist,
+         __stop_sim_persist - __start_sim_persist);
+  _exit(0);
+}
+
+// time(), gettimeofday() and settimeofday() read and set the device clock
+// (linked with --wrap)
+extern "C" int __wrap_gettimeofday(struct timeval *tv, void *) {
+  simChargeCpu();
+  int64_t us = simDeviceTimeUs();
+  tv->tv_sec = us / 1000000;
+  tv->tv_usec = us % 1000000;
+  return 0;
+}
+
+extern "C" time_t __wrap_time(time_t *out) {
+  struct timeval tv;
+  __wrap_gettimeofday(&tv, nullptr);
+  if (out)
+    *out = tv.tv_sec;
+  return tv.tv_sec;
+}
+
+extern "C" int __wrap_settimeofday(const struct timeval *tv, const void *) {
+  simRtc.clockOffsetUs =
+      (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - simTrueTimeUs();
+  return 0;
+}
+
+// Whole file as a NUL-terminated string (nullptr if unreadable)
+static char *readFile(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return nullptr;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *data = (char *)malloc(size + 1);
+  if (data && fread(data, 1, size, f) != (size_t)size) {
+    free(data);
+    data = nullptr;
+  }
+  fclose(f);
+  if (data)
+    data[size] = '\0';
+  return data;
+}
+
+// Split [from, from + us) of deep sleep over the days it covers
+static void addSleep(SimDay *days, int dayCount, uint64_t from, uint64_t us) {
+  while (us > 0) {
+    uint64_t day = from / SIM_DAY_US;
+    if (day >= (uint64_t)dayCount)
+      return;
+    uint64_t part = min(us, (day + 1) * SIM_DAY_US - from);
+    days[day].sleepUs += part;
+    from += part;
+    us -= part;
+  }
+}
+
+// Charge in mAh: each part of the model, then the total
+struct SimCharge {
+  double sleep;
+  double cpu;
+  double radio;
+  double panel;
+  double total;
+};
+
+static SimCharge dayCharge(const SimDay &day, const SimCurrents &ma) {
+  SimCharge c;
+  // mA * us -> mAh
+  c.sleep = ma.sleep * day.sleepUs / 3.6e9;
+  c.cpu = (ma.cpuBase * day.activeUs + ma.perMhz * day.mhzUs) / 3.6e9;
+  c.radio = ma.radio * day.radioUs / 3.6e9;
+  c.panel = (ma.fullRefresh * day.fullRefreshes +
+             ma.partialRefresh * day.partialRefreshes) /
+            3600.0;
+  c.total = c.sleep + c.cpu + c.radio + c.panel;
+  return c;
+}
+
+static bool parseOption(int argc, char **argv, int &i, const char *name,
+                        double *value) {
+  if (strcmp(argv[i], name) != 0 || i + 1 >= argc)
+    return false;
+  *value = atof(argv[++i]);
+  return true;
+}
+
+static bool parseOption(int argc, char **argv, int &i, const char *name,
+                        uint32_t *value) {
+  if (strcmp(argv[i], name) != 0 || i + 1 >= argc)
+    return false;
+  *value = strtoul(argv[++i], nullptr, 10);
+  return true;
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [--days N] [--start EPOCH] [--weather FILE] "
+          "[--remote FILE]\n"
+          "  [--max-age SEC] [--ap SSID|none] [--rssi DBM] [--battery PCT]\n"
+          "  [--boot-ms|--wifi-ms|--dns-ms|--http-ms|--ntp-ms|--full-ms|"
+          "--partial-ms|--panel-off-ms MS]\n"
+          "  [--http-kbps N] [--cpu-scale X] [--ma-cpu-base MA] "
+          "[--ma-per-mhz MA]\n"
+          "  [--ma-radio MA] [--ma-sleep MA] [--mas-full MAS] "
+          "[--mas-partial MAS]\n"
+          "  [--capacity MAH] [--log]\n",
+          program);
+}
+
+int main(int argc, char **argv) {
+  const WifiCredential &firstNetwork = WIFI_CREDENTIALS[0];
+  SimSetup &s = simSetup;
+  s.bootMs = 250;
+  s.wifiMs = 1200;
+  s.dnsMs = 40;
+  s.httpMs = 250;
+  s.httpKbps = 2000;
+  s.ntpMs = 150;
+  s.fullRefreshMs = 3000;
+  s.partialRefreshMs = 500;
+  s.panelOffMs = 80;
+  s.cpuScale = 20;
+  s.batteryPct = 80;
+  strncpy(s.ap, firstNetwork.ssid, sizeof(s.ap) - 1);
+  s.apRssi = -60;
+  s.apChannel = 6;
+
+  SimCurrents ma = {POWER_MA_CPU_BASE,      POWER_MA_PER_MHZ,
+                    POWER_MA_RADIO,         POWER_MA_SLEEP,
+                    POWER_MAS_FULL_REFRESH, POWER_MAS_PARTIAL_REFRESH,
+                    BATTERY_CAPACITY_MAH};
+  uint32_t dayCount = 1;
+  uint32_t start = 1718000000; // Fixed, so runs compare
+  uint32_t battery = s.batteryPct;
+  double rssi = s.apRssi;
+  double cpuScale = s.cpuScale;
+  double maxAge = -1;
+  const char *weatherPath = "bench/forecast_medium.json";
+  const char *remotePath = nullptr;
+  bool log = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (parseOption(argc, argv, i, "--days", &dayCount) ||
+        parseOption(argc, argv, i, "--start", &start) ||
+        parseOption(argc, argv, i, "--max-age", &maxAge) ||
+        parseOption(argc, argv, i, "--rssi", &rssi) ||
+        parseOption(argc, argv, i, "--battery", &battery) ||
+        parseOption(argc, argv, i, "--boot-ms", &s.bootMs) ||
+        parseOption(argc, argv, i, "--wifi-ms", &s.wifiMs) ||
+        parseOption(argc, argv, i, "--dns-ms", &s.dnsMs) ||
+        parseOption(argc, argv, i, "--http-ms", &s.httpMs) ||
+        parseOption(argc, argv, i, "--http-kbps", &s.httpKbps) ||
+        parseOption(argc, argv, i, "--ntp-ms", &s.ntpMs) ||
+        parseOption(argc, argv, i, "--full-ms", &s.fullRefreshMs) ||
+        parseOption(argc, argv, i, "--partial-ms", &s.partialRefreshMs) ||
+        parseOption(argc, argv, i, "--panel-off-ms", &s.panelOffMs) ||
+        parseOption(argc, argv, i, "--cpu-scale", &cpuScale) ||
+        parseOption(argc, argv, i, "--ma-cpu-base", &ma.cpuBase) ||
+        parseOption(argc, argv, i, "--ma-per-mhz", &ma.perMhz) ||
+        parseOption(argc, argv, i, "--ma-radio", &ma.radio) ||
+        parseOption(argc, argv, i, "--ma-sleep", &ma.sleep) ||
+        parseOption(argc, argv, i, "--mas-full", &ma.fullRefresh) ||
+        parseOption(argc, argv, i, "--mas-partial", &ma.partialRefresh) ||
+        parseOption(argc, argv, i, "--capacity", &ma.capacity)) {
+      continue;
+    }
+    if (strcmp(argv[i], "--weather") == 0 && i + 1 < argc) {
+      weatherPath = argv[++i];
+    } else if (strcmp(argv[i], "--remote") == 0 && i + 1 < argc) {
+      remotePath = argv[++i];
+    } else if (strcmp(argv[i], "--ap") == 0 && i + 1 < argc) {
+      const char *ap = argv[++i];
+      strncpy(s.ap, strcmp(ap, "none") == 0 ? "" : ap, sizeof(s.ap) - 1);
+    } else if (strcmp(argv[i], "--log") == 0) {
+      log = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (dayCount < 1 || dayCount > SIM_MAX_DAYS || s.httpKbps == 0) {
+    usage(argv[0]);
+    return 2;
+  }
+  s.batteryPct = min(battery, (uint32_t)100);
+  s.apRssi = constrain(rssi, -100.0, 0.0);
+  s.cpuScale = cpuScale;
+
+  simServer.weather = readFile(weatherPath);
+  simServer.remote = remotePath ? readFile(remotePath) : "{\"mode\": \"normal\"}";
+  simServer.maxAge = maxAge;
+  if (!simServer.weather || !simServer.remote) {
+    fprintf(stderr, "Cannot read %s\n",
+            simServer.weather ? remotePath : weatherPath);
+    return 2;
+  }
+
+  size_t carrySize = __stop_sim_persist - __start_sim_persist;
+  simCarry = (uint8_t *)mmap(nullptr, carrySize, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (simCarry == MAP_FAILED) {
+    perror("mmap");
+    return 2;
+  }
+
+  hostSerialOut = log ? stderr : nullptr;
+  setenv("TZ", "UTC0", 1); // getLocalTime() as on the device
+  tzset();
+
+  // Power-on: the RTC counts from 0 until something sets the clock
+  simStartTime = start;
+  simRtc.clockOffsetUs = -(int64_t)start * 1000000;
+  simRtc.resetReason = ESP_RST_POWERON;
+  simRtc.wakeCause = 0; // ESP_SLEEP_WAKEUP_UNDEFINED
+
+  static SimDay days[SIM_MAX_DAYS];
+  uint64_t endUs = dayCount * SIM_DAY_US;
+  uint32_t wakes = 0;
+  bool stopped = false;
+
+  printf("=== Simulating %lu day(s) from %lu, AP \"%s\", battery %d%% ===\n",
+         (unsigned long)dayCount, (unsigned long)start, s.ap, s.batteryPct);
+  while (simRtc.nowUs < endUs) {
+    uint64_t wakeAt = simRtc.nowUs;
+    memset(&simRtc.wake, 0, sizeof(simRtc.wake));
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      return 2;
+    }
+    if (pid == 0) {
+      simStartWake();
+      setup();
+      fprintf(stderr, "Wake %lu: setup() returned without deep sleep\n",
+              (unsigned long)wakes + 1);
+      _exit(3);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      fprintf(stderr, "Wake %lu failed (status 0x%x)\n",
+              (unsigned long)wakes + 1, status);
+      return 1;
+    }
+    memcpy(__start_sim_persist, simCarry, carrySize);
+    wakes++;
+
+    const SimWake &wake = simRtc.wake;
+    SimDay &day = days[min(wakeAt / SIM_DAY_US, (uint64_t)dayCount - 1)];
+    day.wakes++;
+    day.activeUs += wake.activeUs;
+    day.mhzUs += wake.mhzUs;
+    day.radioUs += wake.radioUs;
+    day.httpRequests += wake.httpRequests;
+    day.fullRefreshes += wake.fullRefreshes;
+    day.partialRefreshes += wake.partialRefreshes;
+
+    if (wake.restarted) {
+      simRtc.resetReason = ESP_RST_SW;
+      simRtc.wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+      continue;
+    }
+    if (wake.sleepUs == 0) {
+      // Only the button could wake it
+      addSleep(days, dayCount, simRtc.nowUs, endUs - simRtc.nowUs);
+      stopped = true;
+      break;
+    }
+    uint64_t sleepUs = min(wake.sleepUs, endUs - simRtc.nowUs);
+    addSleep(days, dayCount, simRtc.nowUs, sleepUs);
+    simRtc.nowUs += wake.sleepUs;
+    simRtc.resetReason = ESP_RST_DEEPSLEEP;
+    simRtc.wakeCause = ESP_SLEEP_WAKEUP_TIMER;
+  }
+
+  printf("%4s %6s %9s %8s %5s %5s %7s %8s %8s %8s %8s %8s\n", "Day",
+         "Wakes", "Active s", "Radio s", "HTTP", "Full", "Partial", "Sleep",
+         "CPU", "Radio", "Panel", "mAh");
+  SimDay all = {};
+  for (uint32_t d = 0; d < dayCount; d++) {
+    const SimDay &day = days[d];
+    SimCharge c = dayCharge(day, ma);
+    printf("%4lu %6lu %9.1f %8.1f %5lu %5lu %7lu %8.2f %8.2f %8.2f %8.2f "
+           "%8.2f\n",
+           (unsigned long)d + 1, (unsigned long)day.wakes,
+           day.activeUs / 1e6, day.radioUs / 1e6,
+           (unsigned long)day.httpRequests, (unsigned long)day.fullRefreshes,
+           (unsigned long)day.partialRefreshes, c.sleep, c.cpu, c.radio,
+           c.panel, c.total);
+    all.wakes += day.wakes;
+    all.activeUs += day.activeUs;
+    all.mhzUs += day.mhzUs;
+    all.radioUs += day.radioUs;
+    all.sleepUs += day.sleepUs;
+    all.httpRequests += day.httpRequests;
+    all.fullRefreshes += day.fullRefreshes;
+    all.partialRefreshes += day.partialRefreshes;
+  }
+
+  double mahPerDay = dayCharge(all, ma).total / dayCount;
+  printf("Projected: %.2f mAh/day, %.0f days per charge (%.0f mAh)\n",
+         mahPerDay, ma.capacity / mahPerDay, ma.capacity);
+  if (energyLedger.lastDayMah10 > 0) {
+    printf("Device ledger: last full day %.1f mAh\n",
+           energyLedger.lastDayMah10 / 10.0);
+  } else {
+    printf("Device ledger: no full day yet (--days 2 or more)\n");
+  }
+  if (stopped) {
+    printf("Stopped after wake %lu: no timer wakeup armed\n",
+           (unsigned long)wakes);
+  }
+  return 0;
+}
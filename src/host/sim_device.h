@@ -0,0 +1,272 @@
+#ifndef HOST_SIM_DEVICE_H
+#define HOST_SIM_DEVICE_H
+
+// Simulated ESP32 for the wake simulator ([env:native_sim],
+// src/host/sim_cli.cpp). The firmware runs unchanged against a virtual
+// clock: delay() and the modelled hardware (WiFi, HTTP, NTP, the panel's
+// BUSY line) advance it instead of waiting, and the host CPU time the
+// firmware itself takes is added, scaled to the ESP32's speed. Meanwhile
+// the active time, CPU MHz, radio-on time, HTTP requests and panel
+// refreshes of the wake are counted.
+//
+// What survives deep sleep on the device (RTC_DATA_ATTR variables, NVS,
+// the RTC clock) is placed in the sim_persist section; sim_cli.cpp carries
+// it from one wake to the next. Everything else starts fresh on every
+// wake, as after a boot.
+
+#include "config.h"
+#include "driver/gpio.h"
+#include "esp_system.h"
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#define SIM_PERSIST __attribute__((section("sim_persist")))
+#define RTC_DATA_ATTR SIM_PERSIST
+#define RTC_NOINIT_ATTR SIM_PERSIST
+#define IRAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define constrain(amt, low, high) \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Timing and surroundings of the simulated device (sim_cli.cpp options)
+struct SimSetup {
+  uint32_t bootMs;          // ROM and bootloader, before setup()
+  uint32_t wifiMs;          // Association and DHCP
+  uint32_t dnsMs;           // One DNS lookup
+  uint32_t httpMs;          // Connect, request and first byte
+  uint32_t httpKbps;        // Response body transfer
+  uint32_t ntpMs;           // SNTP answer
+  uint32_t fullRefreshMs;   // Panel BUSY after a full refresh
+  uint32_t partialRefreshMs; // Panel BUSY after a partial refresh
+  uint32_t panelOffMs;      // Panel BUSY after power off
+  float cpuScale;           // ESP32 at 240 MHz vs the host (0: no CPU time)
+  int batteryPct;
+  char ap[33];              // SSID in range ("" = none)
+  int8_t apRssi;
+  uint8_t apChannel;
+};
+
+// What one wake did (filled in by the shims)
+struct SimWake {
+  uint64_t activeUs;  // Boot to deep sleep
+  uint64_t mhzUs;     // CPU MHz integrated over the active time
+  uint64_t radioUs;   // WiFi on
+  uint32_t httpRequests;
+  uint32_t fullRefreshes;
+  uint32_t partialRefreshes;
+  uint64_t sleepUs;   // Timer wakeup armed for deep sleep (0 = none)
+  bool restarted;     // esp_restart() instead of deep sleep
+};
+
+struct SimRtc {
+  uint64_t nowUs;        // Virtual time since the simulation started
+  int64_t clockOffsetUs; // Device clock minus true time
+  int wakeCause;         // esp_sleep_wakeup_cause_t of this wake
+  int resetReason;       // esp_reset_reason_t of this wake
+  SimWake wake;
+};
+
+static SimSetup simSetup; // Set before the first wake, inherited by all
+static SIM_PERSIST SimRtc simRtc;
+static time_t simStartTime; // True time when the simulation started
+
+static uint64_t simWakeStartUs; // setup() start: millis() == 0
+static uint64_t simCpuSeenNs;   // Host CPU time already charged
+static uint32_t simCpuMhz = 240;
+static bool simRadioOn;
+
+// Armed esp_timer (one is all the firmware uses)
+static void (*simTimerCallback)(void *);
+static void *simTimerArg;
+static uint64_t simTimerAt; // 0 = not armed
+
+// Panel model (epd_panel.h drives it over SPI)
+static bool simPanelData; // DC pin: data, not command
+static uint8_t simPanelCommand;
+static uint8_t simPanelSequence; // Display update control 2 (0x22)
+static uint64_t simPanelBusyUntil;
+
+// Ends the wake: deep sleep or restart. Defined in sim_cli.cpp.
+[[noreturn]] void simEndWake(bool restart);
+
+inline void simAdvanceUs(uint64_t us) {
+  simRtc.nowUs += us;
+  simRtc.wake.activeUs += us;
+  simRtc.wake.mhzUs += (uint64_t)simCpuMhz * us;
+  if (simRadioOn)
+    simRtc.wake.radioUs += us;
+  if (simTimerAt && simRtc.nowUs >= simTimerAt) {
+    simTimerAt = 0; // One shot, like esp_timer_start_once()
+    simTimerCallback(simTimerArg);
+  }
+}
+
+// Charge the host CPU time the firmware used since the last call, as the
+// ESP32 would take it at the current clock
+inline void simChargeCpu() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  uint64_t ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  uint64_t spent = ns - simCpuSeenNs;
+  simCpuSeenNs = ns;
+  if (simSetup.cpuScale > 0)
+    simAdvanceUs(spent * simSetup.cpuScale * 240 / simCpuMhz / 1000);
+}
+
+// Start of a wake in a fresh process: boot, then setup()
+inline void simStartWake() {
+  simCpuSeenNs = 0;
+  simChargeCpu(); // Nothing before the boot counts
+  simAdvanceUs((uint64_t)simSetup.bootMs * 1000);
+  simWakeStartUs = simRtc.nowUs;
+}
+
+// True time and device clock, in microseconds since 1970
+inline int64_t simTrueTimeUs() {
+  return (int64_t)simStartTime * 1000000 + simRtc.nowUs;
+}
+
+inline int64_t simDeviceTimeUs() {
+  return simTrueTimeUs() + simRtc.clockOffsetUs;
+}
+
+// ==================== Arduino core ====================
+
+inline unsigned long millis() {
+  simChargeCpu();
+  return (simRtc.nowUs - simWakeStartUs) / 1000;
+}
+
+inline unsigned long micros() {
+  simChargeCpu();
+  return simRtc.nowUs - simWakeStartUs;
+}
+
+inline void delay(unsigned long ms) {
+  simChargeCpu();
+  simAdvanceUs((uint64_t)ms * 1000);
+}
+
+inline void delayMicroseconds(unsigned int us) {
+  simChargeCpu();
+  simAdvanceUs(us);
+}
+
+inline void yield() {}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+inline int digitalRead(uint8_t pin) {
+  if (pin == ELINK_BUSY)
+    return simRtc.nowUs < simPanelBusyUntil ? HIGH : LOW;
+  return HIGH; // Button (active low) not pressed
+}
+
+inline uint16_t analogRead(uint8_t pin) {
+  if (pin != BATTERY_PIN)
+    return 0;
+  // Inverse of getBatteryVoltage()
+  float voltage = BATTERY_MIN_V + (BATTERY_MAX_V - BATTERY_MIN_V) *
+                                      simSetup.batteryPct / 100.0;
+  return constrain((int)(voltage / 2 / 3.3 * 4095), 0, 4095);
+}
+
+inline int8_t digitalPinToAnalogChannel(uint8_t pin) {
+  return pin == BATTERY_PIN ? 7 : -1; // GPIO35 is ADC1 channel 7
+}
+
+inline bool setCpuFrequencyMhz(uint32_t mhz) {
+  simChargeCpu(); // Time so far was spent at the old clock
+  simCpuMhz = mhz;
+  return true;
+}
+
+inline uint32_t getCpuFrequencyMhz() { return simCpuMhz; }
+
+// One core, no interrupts: the esp_timer callback runs inside the clock
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+inline esp_reset_reason_t esp_reset_reason() {
+  return (esp_reset_reason_t)simRtc.resetReason;
+}
+
+[[noreturn]] inline void esp_restart() { simEndWake(true); }
+
+inline esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) {
+  if (gpio == ELINK_DC)
+    simPanelData = level;
+  return ESP_OK;
+}
+
+// ==================== Panel ====================
+
+// One SPI transfer to the panel, at the bus clock
+inline void simPanelWrite(const uint8_t *bytes, size_t len, int clockHz) {
+  simChargeCpu();
+  simAdvanceUs((uint64_t)len * 8 * 1000000 / clockHz);
+  if (len == 0)
+    return;
+  if (!simPanelData) {
+    simPanelCommand = bytes[0];
+    if (simPanelCommand != 0x20)
+      return;
+    // Master activation: run the sequence set with 0x22
+    uint32_t busyMs = 0;
+    switch (simPanelSequence) {
+    case 0xF7:
+      simRtc.wake.fullRefreshes++;
+      busyMs = simSetup.fullRefreshMs;
+      break;
+    case 0xFC:
+      simRtc.wake.partialRefreshes++;
+      busyMs = simSetup.partialRefreshMs;
+      break;
+    case 0x83:
+      busyMs = simSetup.panelOffMs;
+      break;
+    }
+    simPanelBusyUntil = simRtc.nowUs + (uint64_t)busyMs * 1000;
+  } else if (simPanelCommand == 0x22) {
+    simPanelSequence = bytes[0];
+  }
+}
+
+// ==================== Clock ====================
+// time(), gettimeofday() and settimeofday() use the device clock too:
+// sim_cli.cpp links them --wrap'ed.
+
+static bool simNtpStarted;
+
+inline void configTime(long, int, const char *, const char * = nullptr,
+                       const char * = nullptr) {
+  simNtpStarted = true;
+}
+
+bool simWifiConnected(); // WiFi.h
+
+// SNTP sets the device clock to true time once WiFi is up
+inline bool getLocalTime(struct tm *info, uint32_t ms = 5000) {
+  simChargeCpu();
+  if (!simNtpStarted || !simWifiConnected() || simSetup.ntpMs > ms) {
+    simAdvanceUs((uint64_t)ms * 1000);
+    return false;
+  }
+  simAdvanceUs((uint64_t)simSetup.ntpMs * 1000);
+  simRtc.clockOffsetUs = 0;
+  time_t now = simDeviceTimeUs() / 1000000;
+  return localtime_r(&now, info) != nullptr;
+}
+
+#endif // HOST_SIM_DEVICE_H
@@ -0,0 +1,11 @@
+#ifndef HOST_SOC_RTC_CNTL_REG_H
+#define HOST_SOC_RTC_CNTL_REG_H
+
+// RTC control registers for the wake simulator: writes go nowhere
+
+#define RTC_CNTL_STATE0_REG 0
+#define RTC_CNTL_ULP_CP_SLP_TIMER_EN (1 << 24)
+#define CLEAR_PERI_REG_MASK(reg, mask) ((void)(reg), (void)(mask))
+#define SET_PERI_REG_MASK(reg, mask) ((void)(reg), (void)(mask))
+
+#endif // HOST_SOC_RTC_CNTL_REG_H
@@ -0,0 +1,10 @@
+#ifndef HOST_SOC_RTC_IO_REG_H
+#define HOST_SOC_RTC_IO_REG_H
+
+// RTC IO registers for the wake simulator (only read by the ULP program,
+// which does not run)
+
+#define RTC_GPIO_IN_REG 0x3ff48424
+#define RTC_GPIO_IN_NEXT_S 14
+
+#endif // HOST_SOC_RTC_IO_REG_H
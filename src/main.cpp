@@ -1,9 +1,18 @@
 #include "config.h"
 #include "display_manager.h"
+#include "energy_model.h"
+#include "heap_stats.h"
+#include "power_profile.h"
+#include "ota_update.h"
 #include "remote_mode.h"
+#include "runtime_config.h"
+#include "sd_storage.h"
 #include "sleep_manager.h"
+#include "telemetry.h"
 #include "time_manager.h"
 #include "ui.h"
+#include "ulp_monitor.h"
+#include "wake_budget.h"
 #include "weather.h"
 #include "wifi_manager.h"
 #include <Arduino.h>
@@ -12,26 +21,240 @@
 // These variables persist through deep sleep
 RTC_DATA_ATTR int bootCount = 0;
 RTC_DATA_ATTR int lastWeatherMinute = -1;
-RTC_DATA_ATTR int lastFullRefreshCount = 0;
 RTC_DATA_ATTR bool showMorningMessage = true;
+RTC_DATA_ATTR LayoutState layoutState = {0}; // Widget keys on the panel
+RTC_DATA_ATTR RefreshScheduler refreshScheduler = {0}; // Ghosting per region
 RTC_DATA_ATTR WeatherData savedWeather = {0}; // Persisted weather data
+RTC_DATA_ATTR WeatherView weatherView = {0};  // savedWeather, ready to draw
+RTC_DATA_ATTR uint32_t lastTimeSync = 0;      // Last trusted clock source
+RTC_DATA_ATTR bool wifiOnline = false;        // Last WiFi connect succeeded
+RTC_DATA_ATTR WifiStats wifiStats = {};       // Per-network connect history
+RTC_DATA_ATTR DnsCache dnsCache = {};         // Resolved API hostnames
+RTC_DATA_ATTR TlsSessionCache tlsSession = {}; // TLS session for resumption
+RTC_DATA_ATTR RuntimeConfig runtimeConfig = {0}; // NVS-backed tunables
 
 // Remote mode state (persists through deep sleep)
 RTC_DATA_ATTR bool remoteMode = false;
-RTC_DATA_ATTR uint8_t remoteImageBuffer[BITMAP_SIZE + 100];
+RTC_DATA_ATTR uint8_t remoteImageBuffer[REMOTE_BUFFER_SIZE]
+    __attribute__((aligned(4)));
 RTC_DATA_ATTR size_t remoteImageSize = 0;
+RTC_DATA_ATTR uint8_t remoteImageFlags = 0;
 RTC_DATA_ATTR int remoteSleepDuration = REMOTE_REFRESH_SEC;
+RTC_DATA_ATTR Playlist playlist = {0}; // Prefetched frames stored on SD
+RTC_DATA_ATTR bool remotePaused = false; // Double press: stay in normal mode
+RTC_DATA_ATTR RemoteOverlays remoteOverlays = {0}; // Drawn over the frame
+
+// Server scheduling hints (local deadlines, persist through deep sleep)
+RTC_DATA_ATTR ScheduleHints scheduleHints = {0};
+
+// Telemetry records waiting to be written to the SD card
+RTC_DATA_ATTR TelemetryLog telemetryLog = {0};
+
+// Per-phase CPU time and energy totals
+RTC_DATA_ATTR PowerProfileStats powerStats = {0};
+RTC_DATA_ATTR EnergyLedger energyLedger = {0}; // Tumbling 24 h energy window
+
+// Network work waiting for a wake with budget left
+RTC_DATA_ATTR WakeTaskQueue wakeQueue = {0};
+
+// Wakes left before a freshly installed update is trusted
+RTC_DATA_ATTR uint8_t otaProbationWakes = 0;
+
+// Battery-driven power state
+RTC_DATA_ATTR PowerState powerState = POWER_NORMAL;
+RTC_DATA_ATTR bool lowBatteryShown = false;
+
+// Checked at build time; padding between the variables is not counted,
+// which the margin in RTC_STATE_MAX covers
+static_assert(sizeof(bootCount) + sizeof(lastWeatherMinute) +
+                  sizeof(showMorningMessage) + sizeof(layoutState) +
+                  sizeof(refreshScheduler) + sizeof(savedWeather) +
+                  sizeof(weatherView) + sizeof(lastTimeSync) +
+                  sizeof(wifiOnline) + sizeof(wifiStats) + sizeof(dnsCache) +
+                  sizeof(tlsSession) + sizeof(runtimeConfig) +
+                  sizeof(remoteMode) + sizeof(remoteImageBuffer) +
+                  sizeof(remoteImageSize) + sizeof(remoteImageFlags) +
+                  sizeof(remoteSleepDuration) + sizeof(playlist) +
+                  sizeof(remotePaused) + sizeof(remoteOverlays) +
+                  sizeof(scheduleHints) + sizeof(telemetryLog) +
+                  sizeof(powerStats) + sizeof(energyLedger) +
+                  sizeof(wakeQueue) + sizeof(otaProbationWakes) +
+                  sizeof(powerState) + sizeof(lowBatteryShown) <=
+                  RTC_STATE_MAX,
+              "RTC state does not fit in RTC slow memory");
 
 // ==================== Global Objects ====================
 DisplayManager display;
 WeatherClient weather;
+HeapStats wakeHeapStart; // Allocation counters when setup() started
+
+// Finish the telemetry record for this wake and store it
+// (mounts the SD card only when the RTC buffer is full)
+void recordWake(TelemetryRecord &record) {
+  if (remoteMode) {
+    record.flags |= TELEMETRY_REMOTE_MODE;
+  }
+  time_t now = time(nullptr);
+  record.timestamp = now > 1000000000 ? now : 0; // 0 if clock never set
+  record.batteryMv = getBatteryVoltage() * 1000;
+  record.powerState = powerState;
+  record.wakeMs = millis();
+  reportEnergy(energyLedger, reportPowerProfile(powerStats));
+  reportHeap(wakeHeapStart);
+  telemetryAppend(telemetryLog, record);
+  sdUnmount();
+  otaConfirmWake(otaProbationWakes); // Survived another wake
+}
+
+// Wake hard limit hit (called with the timer or a finished write): sleep
+// a short while with the usual wake sources
+void sleepAfterOverrun() {
+  configureSleepDuration(WAKE_OVERRUN_SLEEP_SEC);
+#if ULP_MONITOR_ENABLED
+  startUlpMonitor(powerState);
+#endif
+  enterDeepSleep();
+}
+
+// Weather due by the fixed interval or the API's freshness hint
+bool weatherDue(bool buttonWake) {
+  if (buttonWake) {
+    Serial.println("Button pressed - forcing weather update");
+    return true;
+  }
+  if (lastWeatherMinute < 0) {
+    Serial.println("First boot - fetching weather");
+    return true;
+  }
+  if (scheduleHints.weatherValidUntil != 0) {
+    // API freshness hint replaces the fixed interval
+    bool due = !hintPending(scheduleHints.weatherValidUntil);
+    if (due) {
+      Serial.println("Weather hint expired - fetching");
+    }
+    return due;
+  }
+  int minutesSinceWeather = getMinutesSinceMidnight() - lastWeatherMinute;
+  if (minutesSinceWeather < 0) {
+    minutesSinceWeather += 24 * 60;
+  }
+  if (minutesSinceWeather >= runtimeConfig.weatherUpdateMin) {
+    Serial.printf("Weather update needed (%d min since last)\n",
+                  minutesSinceWeather);
+    return true;
+  }
+  return false;
+}
+
+// Ask the remote endpoint which mode to be in. Returns true when a new
+// remote frame (or playlist) arrived.
+bool runRemoteCheck(TelemetryRecord &record, OtaOffer &otaOffer) {
+  Serial.println("Checking remote mode status...");
+  RemoteModeResponse response =
+      checkRemoteMode(remoteImageBuffer, &remoteImageSize, &remoteImageFlags,
+                      &playlist, &remoteOverlays, &otaOffer, runtimeConfig,
+                      dnsCache, tlsSession);
+
+  // Any server response doubles as a time source (saves an NTP exchange)
+  setTimeFromServer(response.serverTime, &lastTimeSync);
+
+  if (!response.success) {
+    Serial.println("Remote check failed, keeping current mode");
+    record.httpFailures++;
+    return false;
+  }
+
+  record.flags |= TELEMETRY_REMOTE_OK;
+  scheduleHints.nextRemoteCheck = hintDeadline(response.nextCheckSec);
+  scheduleHints.remoteValidUntil = hintDeadline(response.validForSec);
+  if (!response.isRemote) {
+    if (remoteMode) {
+      Serial.println("Exiting remote mode, returning to normal");
+    }
+    remoteMode = false;
+    return false;
+  }
+
+  remoteMode = true;
+  remoteSleepDuration = response.refreshSeconds;
+  remoteOverlays.nextFetch =
+      remoteOverlays.count > 0
+          ? (uint32_t)time(nullptr) +
+                hintedRemoteSleep(scheduleHints, remoteSleepDuration)
+          : 0;
+  Serial.printf("Entering remote mode (refresh: %ds)\n",
+                remoteSleepDuration);
+  return !playlist.waiting; // A first frame with a display_at waits for it
+}
+
+// Fetch the weather and rebuild the view. Returns true on success.
+bool runWeatherUpdate(TelemetryRecord &record) {
+  bool fetched = weather.fetchWeather(runtimeConfig, dnsCache, tlsSession);
+  setTimeFromServer(parseHttpDate(weather.getServerDate()), &lastTimeSync);
+  if (!fetched) {
+    record.httpFailures++;
+    return false;
+  }
+
+  lastWeatherMinute = getMinutesSinceMidnight();
+  savedWeather = weather.getWeather();
+  buildWeatherView(display, weather.getWeather(), weatherView);
+  record.flags |= TELEMETRY_WEATHER_OK;
+
+  // Honour the API's freshness hint, but never poll more often than
+  // weatherUpdateMin
+  long validFor = weather.getValidForSec();
+  scheduleHints.weatherValidUntil =
+      validFor >= 0
+          ? hintDeadline(max(validFor, runtimeConfig.weatherUpdateMin * 60L))
+          : 0;
+  Serial.printf("Weather updated and saved, next update in %d min\n",
+                runtimeConfig.weatherUpdateMin);
+  return true;
+}
+
+// Put the current mode's screen on the panel. newFrame: the remote frame
+// changed since it was last shown (full refresh); otherwise only changed
+// widgets or overlays are refreshed.
+void renderScreen(bool newFrame) {
+  if (remoteMode && remoteImageSize > 0) {
+    // Remote mode: the remote image with any local overlays on top
+    drawRemoteScreen(display, remoteImageBuffer, remoteImageFlags,
+                     remoteOverlays, weatherView, wifiOnline, newFrame);
+    layoutState.valid = false; // Main screen must be redrawn in full
+    return;
+  }
+
+  // Normal mode: weather and time display
+  HeapStats drawStart = heapStatsNow();
+  drawMainScreen(display, weatherView, showMorningMessage, wifiOnline,
+                 layoutState);
+  // The render path is meant to be allocation-free (counted in
+  // HEAP_ACCOUNTING builds, zero otherwise)
+  HeapStats drawHeap = heapStatsSince(drawStart);
+  if (drawHeap.allocs > 0) {
+    Serial.printf("Heap: main screen made %lu allocations (%lu bytes)\n",
+                  (unsigned long)drawHeap.allocs,
+                  (unsigned long)drawHeap.bytes);
+  }
+  remoteOverlays.drawn = false; // Remote frame must be redrawn in full
+}
 
 void setup() {
   // Increment boot counter
   bootCount++;
+  wakeHeapStart = heapStatsNow();
+
+  // Boot work (display init, image decode, render) is compute bound
+  setPowerPhase(PHASE_COMPUTE);
 
   // Initialize serial
   Serial.begin(115200);
+
+  // A new image that keeps crashing goes back to the previous one before
+  // it gets to run anything else
+  otaCheckProbation(esp_reset_reason(), otaProbationWakes);
+
   Serial.println("\n=== Morning ESP32 E-Ink Display ===");
   Serial.printf("Boot count: %d\n", bootCount);
   Serial.printf("Remote mode: %s\n", remoteMode ? "YES" : "NO");
@@ -39,16 +262,45 @@ void setup() {
   // Print wakeup reason
   printWakeupReason();
 
-  // Check if this is a button wake
-  bool buttonWake = isButtonWakeup();
+  // Per-wake time accounting (the hard limit is armed for network work)
+  bool lastWakeOverran = startWakeBudget(wakeQueue);
 
-  // Initialize display
-  display.begin();
+  // Runtime tunables (RTC copy, NVS after power-on, else build defaults)
+  loadRuntimeConfig(runtimeConfig);
+
+  // Check if this is a button wake (EXT0, or a gesture seen by the ULP)
+  ButtonGesture gesture = getUlpGesture();
+  stopUlpMonitor();
+  bool buttonWake = isButtonWakeup() || gesture != BUTTON_NONE;
+
+  if (gesture == BUTTON_LONG) {
+    // Force refresh: ignore server hints and drop prefetched frames
+    Serial.println("Long press - forcing full refresh");
+    scheduleHints = {0};
+    clearPlaylist(playlist);
+  } else if (gesture == BUTTON_DOUBLE) {
+    remotePaused = !remotePaused;
+    Serial.printf("Double press - remote mode %s\n",
+                  remotePaused ? "paused" : "resumed");
+    if (remotePaused) {
+      remoteMode = false;
+      clearPlaylist(playlist);
+    }
+  }
+
+  // Initialize display (controller RAM survives deep sleep, reset only on
+  // power-on)
+  display.begin(bootCount == 1);
+  refreshScheduler.maxPartials = runtimeConfig.ghostMaxPartials;
+  display.setRefreshScheduler(&refreshScheduler);
 
   // Load saved weather data from RTC memory
   if (savedWeather.valid) {
     weather.setWeather(savedWeather);
     Serial.println("Loaded weather from RTC memory");
+    if (!weatherView.valid) {
+      buildWeatherView(display, weather.getWeather(), weatherView);
+    }
   }
 
   // Show startup message on first boot
@@ -59,107 +311,220 @@ void setup() {
     display.update();
   }
 
-  // Connect to WiFi
-  bool wifiConnected = connectWiFi();
+  // Telemetry for this wake
+  TelemetryRecord record = {0};
+  record.bootCount = bootCount;
+  record.wakeReason = getWakeupReason();
+  record.resetReason = esp_reset_reason();
+  if (lastWakeOverran) {
+    record.flags |= TELEMETRY_OVERRUN;
+  }
+
+  // ==================== Power State ====================
+  // Read the battery before the radio loads it
+  powerState =
+      updatePowerState(powerState, getBatteryPercentage(), isCharging());
 
-  // ==================== Remote Mode Check ====================
-  // Check remote mode if:
+  if (powerState == POWER_CRITICAL) {
+    // Leave a clean "charge me" frame and stop waking on the timer
+    if (!lowBatteryShown) {
+      drawLowBatteryScreen(display);
+      lowBatteryShown = true;
+      layoutState.valid = false;
+      remoteOverlays.drawn = false;
+    }
+    recordWake(record);
+    configureButtonOnlySleep();
+#if ULP_MONITOR_ENABLED
+    startUlpMonitor(powerState); // Also wakes us when charging starts
+#endif
+    enterDeepSleep();
+  }
+  lowBatteryShown = false;
+
+  // Reduced power: timer wakes stay offline, the button still refreshes
+  bool reducedPower = powerState == POWER_REDUCED && !buttonWake;
+
+  // ==================== Offline Playlist ====================
+  // In remote mode, timer wakes step through prefetched frames without
+  // turning the radio on. Go online when the playlist runs out or on button.
+  bool playlistWake = false;
+  if (remoteMode && !buttonWake && playlistHasNext(playlist)) {
+    playlistWake = playlistAdvance(playlist, remoteImageBuffer,
+                                   REMOTE_BUFFER_SIZE, &remoteImageSize,
+                                   &remoteImageFlags);
+    if (!playlistWake) {
+      remoteImageSize = 0; // Buffer may be partially overwritten
+    }
+  }
+
+  // A remote frame with local overlays is only fetched again when its
+  // content is due; timer wakes in between just redraw the overlays
+  bool overlayWake = remoteMode && !buttonWake && !playlistWake &&
+                     remoteImageSize > 0 && remoteOverlays.count > 0 &&
+                     hintPending(remoteOverlays.nextFetch);
+
+  // The RTC clock is good enough for the first render; network time
+  // sources are tried below as queued work
+  bool timeOk = syncTime(&lastTimeSync, false);
+
+  // ==================== Deferred Work ====================
+  // Queue what became due this wake (work put off earlier stays queued).
+  // Remote check if:
   // - Currently in remote mode (need to refresh/check if still active)
   // - Button pressed (manual check)
-  // - Every REMOTE_CHECK_CYCLES wakes in normal mode
-  bool shouldCheckRemote = remoteMode || buttonWake ||
-                           (bootCount % REMOTE_CHECK_CYCLES == 0);
-
-  if (shouldCheckRemote && wifiConnected) {
-    Serial.println("Checking remote mode status...");
-    RemoteModeResponse response =
-        checkRemoteMode(remoteImageBuffer, &remoteImageSize);
-
-    if (response.success) {
-      if (response.isRemote) {
-        remoteMode = true;
-        remoteSleepDuration = response.refreshSeconds;
-        Serial.printf("Entering remote mode (refresh: %ds)\n",
-                      remoteSleepDuration);
-      } else {
-        if (remoteMode) {
-          Serial.println("Exiting remote mode, returning to normal");
-        }
-        remoteMode = false;
-      }
-    } else {
-      Serial.println("Remote check failed, keeping current mode");
-    }
+  // - Every remoteCheckCycles wakes in normal mode
+  // unless the server asked us not to check before a given time
+  bool remoteHintWait =
+      !buttonWake && hintPending(scheduleHints.nextRemoteCheck);
+  if (!playlistWake && !overlayWake && !remoteHintWait && !remotePaused &&
+      (remoteMode || buttonWake ||
+       (bootCount % runtimeConfig.remoteCheckCycles == 0))) {
+    queueTask(wakeQueue, TASK_REMOTE_CHECK);
+  }
+  if (!remoteMode && weatherDue(buttonWake)) {
+    queueTask(wakeQueue, TASK_WEATHER);
+  }
+  bool clockShown = !remoteMode || remoteOverlays.count > 0;
+  if (clockShown && timeSyncDue(lastTimeSync)) {
+    queueTask(wakeQueue, TASK_TIME_SYNC);
+  }
+  if (telemetryUploadDue(telemetryLog)) {
+    queueTask(wakeQueue, TASK_TELEMETRY);
   }
 
   // ==================== Display Update ====================
-  if (remoteMode && remoteImageSize > 0) {
-    // Remote mode: draw the remote image
-    drawRemoteImage(display, remoteImageBuffer, remoteImageSize);
-  } else {
-    // Normal mode: weather and time display
+  // What is known locally goes on the panel before any network work.
+  // Anti-ghosting is up to the refresh scheduler: regions that had too
+  // many partial refreshes get a clean refresh when next touched, and the
+  // whole screen a full one in the nightly quiet window.
+  showMorningMessage = !showMorningMessage;
+  bool wasRemote = remoteMode;
+  bool wasOnline = wifiOnline;
+  bool rendered = timeOk || (remoteMode && remoteImageSize > 0 &&
+                             remoteOverlays.count == 0);
+  if (rendered) {
+    renderScreen(playlistWake);
+  }
 
-    // Sync time from NTP
-    bool timeOk = syncTime();
-    if (!timeOk) {
-      Serial.println("Time sync failed, will retry next wake");
+  // ==================== Queued Tasks ====================
+  // In priority order while the wake budget lasts. The radio only comes
+  // up for a task that fits (never for prefetched frames, overlay-only
+  // wakes or in reduced power). The hard limit cuts off a hung server.
+  armWakeLimit(sleepAfterOverrun);
+  bool radioAllowed = !playlistWake && !overlayWake && !reducedPower;
+  bool wifiConnected = false;
+  bool newFrame = false;
+  bool weatherFetched = false;
+  OtaOffer otaOffer = {0};
+  for (uint8_t i = 0; i < WAKE_TASK_COUNT && radioAllowed; i++) {
+    WakeTask task = (WakeTask)i;
+    if (!taskQueued(wakeQueue, task)) {
+      continue;
+    }
+    if ((task == TASK_REMOTE_CHECK && remotePaused) ||
+        (task == TASK_WEATHER && remoteMode) ||
+        (task == TASK_TELEMETRY && !telemetryUploadDue(telemetryLog))) {
+      dropTask(wakeQueue, task);
+      continue;
+    }
+    if (task == TASK_TELEMETRY && !wifiConnected) {
+      continue; // Waits for a wake that has the radio up anyway
+    }
+    if (!taskFits(wakeQueue, task, wifiConnected)) {
+      deferTask(wakeQueue, task);
+      record.flags |= TELEMETRY_DEFERRED;
+      continue;
     }
 
-    // Check if weather needs update
-    int currentMinute = getMinutesSinceMidnight();
-    bool needWeather = false;
-
-    if (buttonWake) {
-      Serial.println("Button pressed - forcing weather update");
-      needWeather = true;
-    } else if (lastWeatherMinute < 0) {
-      Serial.println("First boot - fetching weather");
-      needWeather = true;
-    } else {
-      int minutesSinceWeather = currentMinute - lastWeatherMinute;
-      if (minutesSinceWeather < 0) {
-        minutesSinceWeather += 24 * 60;
-      }
-      if (minutesSinceWeather >= WEATHER_UPDATE_MIN) {
-        Serial.printf("Weather update needed (%d min since last)\n",
-                      minutesSinceWeather);
-        needWeather = true;
+    if (!wifiConnected) {
+      uint32_t connectStart = millis();
+      wifiConnected = connectWiFi(wifiStats);
+      wifiOnline = wifiConnected;
+      if (!wifiConnected) {
+        break; // Everything stays queued for the next wake
       }
+      recordWifiCost(wakeQueue, millis() - connectStart);
+      record.flags |= TELEMETRY_WIFI_OK;
+      record.rssi = WiFi.RSSI();
     }
 
-    // Fetch weather if needed
-    if (needWeather && wifiConnected) {
-      if (weather.fetchWeather()) {
-        lastWeatherMinute = currentMinute;
-        savedWeather = weather.getWeather();
-        Serial.printf("Weather updated and saved, next update in %d min\n",
-                      WEATHER_UPDATE_MIN);
+    uint32_t taskStart = millis();
+    beginTask(wakeQueue, task);
+    switch (task) {
+    case TASK_REMOTE_CHECK:
+      newFrame = runRemoteCheck(record, otaOffer);
+      if (!remoteMode && weatherDue(false)) {
+        queueTask(wakeQueue, TASK_WEATHER); // Back in normal mode
       }
+      break;
+    case TASK_WEATHER:
+      weatherFetched = runWeatherUpdate(record);
+      break;
+    case TASK_TIME_SYNC:
+      // Usually settled by a server Date header above, else NTP
+      timeOk = syncTime(&lastTimeSync, true);
+      if (!timeOk) {
+        Serial.println("Time sync failed, will retry next wake");
+      }
+      break;
+    case TASK_TELEMETRY:
+      if (!telemetryUpload(telemetryLog, dnsCache, tlsSession)) {
+        record.httpFailures++;
+      }
+      break;
+    default:
+      break;
     }
+    finishTask(wakeQueue, task, millis() - taskStart);
+  }
+  stopWakeBudget();
+  if (timeOk) {
+    record.flags |= TELEMETRY_TIME_OK;
+  }
 
-    // Toggle morning message on each wake
-    showMorningMessage = !showMorningMessage;
-
-    // Check if full refresh is needed (prevents ghosting)
-    lastFullRefreshCount++;
-    if (lastFullRefreshCount >= FULL_REFRESH_CYCLES) {
-      Serial.println("Performing full display refresh");
-      lastFullRefreshCount = 0;
-    }
+  // Show what the tasks brought in (the main screen only refreshes the
+  // widgets that actually changed)
+  if (!rendered || newFrame || weatherFetched || remoteMode != wasRemote ||
+      wifiOnline != wasOnline) {
+    renderScreen(newFrame || (!rendered && playlistWake));
+  }
 
-    // Draw the main screen
-    drawMainScreen(display, weather, showMorningMessage);
+  // Firmware update on a wake that already has the radio up (does not
+  // return when an update was installed). It has its own timeouts and is
+  // written to the other slot, so it runs outside the hard limit.
+  if (wifiConnected && powerState == POWER_NORMAL &&
+      otaOffer.version > FIRMWARE_VERSION) {
+    otaApplyDelta(otaOffer, dnsCache, tlsSession);
   }
 
   // Disconnect WiFi to save power
   disconnectWiFi();
 
+  recordWake(record);
+
   // Configure sleep duration based on mode
   if (remoteMode) {
-    configureSleepDuration(remoteSleepDuration);
+    int sleepSec = playlist.count > 0
+                       ? playlistSleepSeconds(playlist, remoteSleepDuration)
+                       : hintedRemoteSleep(scheduleHints, remoteSleepDuration);
+    if (playlist.count == 0 && remoteOverlays.count > 0) {
+      // Wake for the overlays (clock) until the content is due
+      sleepSec = constrain(secondsUntil(remoteOverlays.nextFetch), 1,
+                           (int)runtimeConfig.sleepSec);
+    }
+    if (powerState == POWER_REDUCED) {
+      sleepSec = max(sleepSec, REDUCED_SLEEP_SEC);
+    }
+    configureSleepDuration(sleepSec);
+  } else if (powerState == POWER_REDUCED) {
+    configureSleepDuration(REDUCED_SLEEP_SEC);
   } else {
-    configureSleep();
+    configureSleepDuration(runtimeConfig.sleepSec);
   }
+#if ULP_MONITOR_ENABLED
+  startUlpMonitor(powerState);
+#endif
 
   enterDeepSleep();
 
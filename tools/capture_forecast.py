@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Capture real forecast.json responses for the host benchmarks.
+
+Fetches three WeatherAPI responses and writes them, unmodified, to the
+fixtures the benchmarks parse ([env:native_bench], bench/):
+
+    forecast_small.json   days=1, one hour       (smallest useful response)
+    forecast_medium.json  days=1, all 24 hours   (what the firmware requests)
+    forecast_large.json   days=3, all hours      (the free plan's maximum)
+
+    python3 tools/capture_forecast.py --key YOUR_KEY --location Porto,PT
+
+The parameters match WeatherClient::buildUrl (lang=pt), so the condition
+texts are the ones the device sees. Record a new benchmark baseline after
+replacing the fixtures (program --record), since parse times change.
+"""
+
+import argparse
+import os
+import urllib.parse
+import urllib.request
+
+API_URL = "https://api.weatherapi.com/v1/forecast.json"
+CAPTURES = (
+    ("small", {"days": 1, "hour": 12}),
+    ("medium", {"days": 1}),
+    ("large", {"days": 3}),
+)
+
+
+def fetch(key, location, params):
+    query = {"key": key, "q": location, "lang": "pt"}
+    query.update(params)
+    url = API_URL + "?" + urllib.parse.urlencode(query)
+    with urllib.request.urlopen(url, timeout=30) as response:
+        return response.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--key", required=True, help="WeatherAPI key")
+    parser.add_argument("--location", default="Porto,PT")
+    parser.add_argument("--out", default="bench", help="fixtures directory")
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    for name, params in CAPTURES:
+        body = fetch(args.key, args.location, params)
+        path = os.path.join(args.out, "forecast_%s.json" % name)
+        with open(path, "wb") as f:
+            f.write(body)
+        print("%-6s %6d bytes -> %s" % (name, len(body), path))
+
+
+if __name__ == "__main__":
+    main()
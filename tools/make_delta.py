@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Build a delta OTA update for the display (see include/ota_update.h).
+
+The delta rebuilds new.bin from the image currently running on the device
+(old.bin) plus literal bytes, so only the changed parts are downloaded.
+
+    python3 tools/make_delta.py old.bin new.bin delta.bin \\
+        --version 4 --url http://192.168.1.173:3000/fw/delta.bin
+
+Prints the "firmware" object to add to the remote endpoint's response.
+Serve delta.bin from any HTTP server (e.g. python3 -m http.server).
+"""
+
+import argparse
+import hashlib
+import json
+import struct
+
+MAGIC = b"MDLT"
+FORMAT = 1
+OP_END, OP_COPY, OP_INSERT = 0, 1, 2
+KEY = 16       # Bytes that must match to start a copy
+MIN_COPY = 32  # Shorter matches are cheaper as literals
+ALIGN = 4      # Index the old image at this granularity
+
+
+def build_delta(old, new):
+    index = {}
+    for offset in range(0, len(old) - KEY + 1, ALIGN):
+        index.setdefault(old[offset:offset + KEY], offset)
+
+    out = bytearray(MAGIC + bytes([FORMAT, 0, 0, 0]))
+    out += struct.pack("<I", len(new))
+    literal = bytearray()
+    copied = 0
+
+    def flush_literal():
+        if literal:
+            out.extend(struct.pack("<BI", OP_INSERT, len(literal)))
+            out.extend(literal)
+            literal.clear()
+
+    i = 0
+    while i < len(new):
+        start = index.get(new[i:i + KEY])
+        length = 0
+        if start is not None:
+            while (i + length < len(new) and start + length < len(old)
+                   and new[i + length] == old[start + length]):
+                length += 1
+        if length >= MIN_COPY:
+            flush_literal()
+            out += struct.pack("<BII", OP_COPY, start, length)
+            copied += length
+            i += length
+        else:
+            literal.append(new[i])
+            i += 1
+
+    flush_literal()
+    out.append(OP_END)
+    return bytes(out), copied
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("old", help="image running on the device")
+    parser.add_argument("new", help="image to install")
+    parser.add_argument("delta", help="output file")
+    parser.add_argument("--version", type=int, required=True,
+                        help="FIRMWARE_VERSION of the new image")
+    parser.add_argument("--url", required=True, help="where delta is served")
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    delta, copied = build_delta(old, new)
+    with open(args.delta, "wb") as f:
+        f.write(delta)
+
+    print("Delta: %d bytes for a %d byte image (%d%% copied from old)"
+          % (len(delta), len(new), 100 * copied // max(len(new), 1)))
+    # The device reports the SHA-256 appended to its running image
+    offer = {
+        "version": args.version,
+        "url": args.url,
+        "base_sha256": old[-32:].hex(),
+        "sha256": hashlib.sha256(new).hexdigest(),
+        "size": len(new),
+    }
+    print('"firmware": ' + json.dumps(offer, indent=2))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Pre-render remote-mode frames with the host frame renderer.
+
+Build [env:native_render] (include/frame_renderer.h, src/host/) once,
+then feed it a JSON list of render requests. Each frame is drawn by the
+firmware's own widget code and fonts, so the result matches the main
+screen pixel for pixel, without a board.
+
+    pio run -e native_render
+    python3 tools/render_frames.py requests.json --out response.json
+
+"display_at" and "duration" in a request are kept for the playlist and
+not sent to the renderer. The output is a remote-mode response: a single
+"image", or "frames" when there is more than one request.
+"""
+
+import argparse
+import base64
+import json
+import os
+import subprocess
+
+RENDERER = ".pio/build/native_render/program"
+PLAYLIST_KEYS = ("display_at", "duration")
+
+
+def render(renderer, request):
+    line = json.dumps(request, separators=(",", ":"))
+    renderer.stdin.write(line + "\n")
+    renderer.stdin.flush()
+    reply = renderer.stdout.readline().strip()
+    if not reply:
+        raise RuntimeError("renderer exited (built with pio run -e "
+                           "native_render?)")
+    if reply.startswith("ERROR"):
+        raise RuntimeError(reply)
+    _, size, image = reply.split(" ", 2)
+    data = base64.b64decode(image)
+    if len(data) != int(size):
+        raise RuntimeError("frame truncated")
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("requests", help="JSON list of render requests")
+    parser.add_argument("--renderer", default=RENDERER,
+                        help="native_render binary (default: %(default)s)")
+    parser.add_argument("--out", default="-",
+                        help="remote response file (default: stdout)")
+    parser.add_argument("--raw", help="also write frame_N.bin to this dir")
+    parser.add_argument("--refresh-seconds", type=int,
+                        help="refresh_seconds for the response")
+    args = parser.parse_args()
+
+    with open(args.requests) as f:
+        requests = json.load(f)
+    if isinstance(requests, dict):
+        requests = [requests]
+
+    frames = []
+    renderer = subprocess.Popen([args.renderer], stdin=subprocess.PIPE,
+                                stdout=subprocess.PIPE,
+                                universal_newlines=True)
+    try:
+        for i, request in enumerate(requests):
+            playlist = {k: request.pop(k) for k in PLAYLIST_KEYS
+                        if k in request}
+            data = render(renderer, request)
+            if args.raw:
+                os.makedirs(args.raw, exist_ok=True)
+                with open(os.path.join(args.raw, "frame_%d.bin" % i),
+                          "wb") as f:
+                    f.write(data)
+            frame = {"image": base64.b64encode(data).decode()}
+            frame.update(playlist)
+            frames.append(frame)
+    finally:
+        renderer.stdin.close()
+        renderer.wait()
+
+    response = {"mode": "remote", "layout": "panel"}
+    if args.refresh_seconds:
+        response["refresh_seconds"] = args.refresh_seconds
+    if len(frames) == 1:
+        response["image"] = frames[0]["image"]
+    else:
+        response["frames"] = frames
+
+    text = json.dumps(response, indent=2)
+    if args.out == "-":
+        print(text)
+    else:
+        with open(args.out, "w") as f:
+            f.write(text + "\n")
+        print("Rendered %d frame(s) into %s" % (len(frames), args.out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Stand-in receiver for the display's batched telemetry.
+
+Listens for the POST sent to TELEMETRY_URL and prints each record.
+The body is a TelemetryUploadHeader followed by TelemetryRecord
+entries, both from include/telemetry.h. The SD card log telemetry2.bin
+has the same layout (count 0, records to the end of the file); the
+telemetry.bin of older firmware is bare 16-byte version 1 records.
+
+    python3 tools/telemetry_receiver.py --port 8080
+    python3 tools/telemetry_receiver.py --file telemetry2.bin  # SD card log
+"""
+
+import argparse
+import datetime
+import struct
+from http.server import BaseHTTPRequestHandler, HTTPServer
+
+MAGIC = 0x314D4C54  # "TLM1"
+HEADER = struct.Struct("<IBBBB6sH")
+RECORD = struct.Struct("<IIHHbBBBBBH")
+RECORD_V1 = struct.Struct("<IIHHbBBB")  # No reset reason / HTTP failures
+
+FLAGS = ["wifi", "weather", "remote", "remote_mode", "time", "deferred",
+         "overrun"]
+WAKE_REASONS = {0: "reset", 2: "button", 3: "ext1", 4: "timer",
+                5: "touch", 6: "ulp"}
+RESET_REASONS = {0: "unknown", 1: "poweron", 2: "ext", 3: "sw", 4: "panic",
+                 5: "int_wdt", 6: "task_wdt", 7: "wdt", 8: "deepsleep",
+                 9: "brownout", 10: "sdio"}
+POWER_STATES = ["normal", "reduced", "critical"]
+
+
+def format_record(data):
+    if len(data) == RECORD_V1.size:
+        fields = RECORD_V1.unpack(data) + (None, None, 0)
+    else:
+        fields = RECORD.unpack(data)
+    (boot, timestamp, wake_ms, battery_mv, rssi, flags, wake, power,
+     reset, http_failures, _) = fields
+    when = (datetime.datetime.fromtimestamp(
+        timestamp, datetime.timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+        if timestamp else "-")
+    names = [n for i, n in enumerate(FLAGS) if flags & (1 << i)]
+    return ("#%-6d %-20s %5d ms %4d mV %4d dBm wake=%-6s reset=%-9s "
+            "power=%-8s http_fail=%s %s" % (
+                boot, when, wake_ms, battery_mv, rssi,
+                WAKE_REASONS.get(wake, wake),
+                "-" if reset is None else RESET_REASONS.get(reset, reset),
+                POWER_STATES[power] if power < 3 else power,
+                "-" if http_failures is None else http_failures,
+                ",".join(names)))
+
+
+def read_header(data):
+    magic, version, record_size, count, _, mac, _ = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError("bad magic 0x%08x" % magic)
+    if record_size != RECORD.size:
+        raise ValueError("version %d record size %d, expected %d"
+                         % (version, record_size, RECORD.size))
+    return version, count, mac
+
+
+def decode_upload(body):
+    version, count, mac = read_header(body)
+    print("Device %s: %d records (v%d)" % (mac.hex(":"), count, version))
+    for i in range(count):
+        offset = HEADER.size + i * RECORD.size
+        print("  " + format_record(body[offset:offset + RECORD.size]))
+
+
+def decode_file(data):
+    # telemetry2.bin starts with a header; telemetry.bin is bare v1 records
+    if data[:4] == struct.pack("<I", MAGIC):
+        version, _, mac = read_header(data)
+        print("Device %s: SD log (v%d)" % (mac.hex(":"), version))
+        start, size = HEADER.size, RECORD.size
+    else:
+        print("SD log (v1, no header)")
+        start, size = 0, RECORD_V1.size
+    for offset in range(start, len(data) - size + 1, size):
+        print(format_record(data[offset:offset + size]))
+
+
+class Handler(BaseHTTPRequestHandler):
+    def do_POST(self):
+        body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        try:
+            decode_upload(body)
+            self.send_response(204)
+        except (ValueError, struct.error) as e:
+            print("Rejected upload: %s" % e)
+            self.send_response(400)
+        self.end_headers()
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--file",
+                        help="decode an SD card telemetry2.bin/telemetry.bin")
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            decode_file(f.read())
+        return
+
+    print("Listening on port %d" % args.port)
+    HTTPServer(("", args.port), Handler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()